@@ -0,0 +1,85 @@
+#ifndef ATTACKS_H
+#define ATTACKS_H
+
+#include "bitboard.h"
+
+#ifdef USE_PEXT
+#include <immintrin.h>
+#endif
+
+// Attack sets of the pieces whose moves don't depend on occupancy, computed
+// by the compiler.
+struct LeaperAttacks {
+    Bitboard knight[64];
+    Bitboard king[64];
+    Bitboard pawn[2][64];
+
+    constexpr LeaperAttacks();
+};
+
+// Squares strictly between two aligned squares, and the whole rank, file or
+// diagonal through them. Both are empty for squares that don't share a line.
+struct LineTables {
+    Bitboard between[64][64];
+    Bitboard line[64][64];
+
+    constexpr LineTables();
+};
+
+// Fancy magic (or PEXT) lookup for one square of a sliding piece
+struct Magic {
+    Bitboard mask;
+    Bitboard magic;
+    Bitboard* attacks;
+    unsigned shift;
+
+    unsigned index(Bitboard occupied) const {
+#ifdef USE_PEXT
+        return unsigned(_pext_u64(occupied, mask));
+#else
+        return unsigned(((occupied & mask) * magic) >> shift);
+#endif
+    }
+};
+
+extern const LeaperAttacks leaperAttacks;
+extern const LineTables lineTables;
+extern Magic rookMagics[64];
+extern Magic bishopMagics[64];
+
+inline Bitboard knightAttacks(int square) {
+    return leaperAttacks.knight[square];
+}
+
+inline Bitboard kingAttacks(int square) {
+    return leaperAttacks.king[square];
+}
+
+// Squares a pawn of the given colour standing on square attacks
+inline Bitboard pawnAttacks(Color color, int square) {
+    return leaperAttacks.pawn[color][square];
+}
+
+inline Bitboard rookAttacks(int square, Bitboard occupied) {
+    const Magic& m = rookMagics[square];
+    return m.attacks[m.index(occupied)];
+}
+
+inline Bitboard bishopAttacks(int square, Bitboard occupied) {
+    const Magic& m = bishopMagics[square];
+    return m.attacks[m.index(occupied)];
+}
+
+inline Bitboard queenAttacks(int square, Bitboard occupied) {
+    return rookAttacks(square, occupied) | bishopAttacks(square, occupied);
+}
+
+inline Bitboard betweenBB(int a, int b) {
+    return lineTables.between[a][b];
+}
+
+inline Bitboard lineBB(int a, int b) {
+    return lineTables.line[a][b];
+}
+
+#endif // ATTACKS_H
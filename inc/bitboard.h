@@ -0,0 +1,45 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <cstdint>
+#include "position.h"
+
+// One bit per square, a1 = bit 0, h1 = bit 7, h8 = bit 63
+typedef uint64_t Bitboard;
+
+enum Color : uint8_t { WHITE, BLACK };
+
+enum PieceType : uint8_t { PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING, PIECE_TYPE_NB };
+
+inline int squareOf(int x, int y) {
+    return y * 8 + x;
+}
+
+inline int squareOf(const Position& pos) {
+    return pos.y * 8 + pos.x;
+}
+
+inline Position positionOf(int square) {
+    return Position(square & 7, square >> 3);
+}
+
+inline Bitboard squareBB(int square) {
+    return Bitboard(1) << square;
+}
+
+inline int popCount(Bitboard b) {
+    return __builtin_popcountll(b);
+}
+
+// Index of the least significant set bit; b must be non-zero
+inline int lsb(Bitboard b) {
+    return __builtin_ctzll(b);
+}
+
+inline int popLsb(Bitboard& b) {
+    int square = lsb(b);
+    b &= b - 1;
+    return square;
+}
+
+#endif // BITBOARD_H
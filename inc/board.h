@@ -3,40 +3,114 @@
 
 #include <vector>
 #include <memory>
-#include "player.h"
+#include <string>
 #include "pieces.h"
-#include "playeraction.h"
+#include "boardstate.h"
+#include "move.h"
+#include "movegen.h"
 
+// Everything makeMove() changes that cannot be recomputed from the move itself
+struct UndoEntry {
+    Move move;
+    uint8_t moved;
+    uint8_t captured;
+    uint8_t capturedSquare;  // Differs from move.to for en passant
+    uint8_t castling;
+    uint8_t epFile;
+    uint64_t key;
+};
+
+// State of the game for the side to move
+enum class GameStatus {
+    Normal,
+    Check,
+    Checkmate,
+    Stalemate
+};
+
+// Compatibility facade over the bitboard position core. Speculative moves are
+// played in place with makeMove() and taken back with unmakeMove(); copying a
+// Board only copies the BoardState and the undo entries in use.
 class Board {
-    std::vector<std::vector<std::shared_ptr<Piece>>> squares;
-    bool whiteTurn;
-    std::pair<Position, Position> lastMove;
+    static const int MAX_UNDO = 256;
+
+    BoardState state;
+    UndoEntry undoStack[MAX_UNDO];
+    int ply;
+
+    // status() of the position whose key is statusKey
+    mutable uint64_t statusKey;
+    mutable GameStatus cachedStatus;
+    mutable bool statusCached;
+
+    void commitMove(const Move& move);
 
 public:
     Board();
     Board(const Board& other);
     Board& operator=(const Board& other);
-    
-    std::shared_ptr<Piece> at(const Position& pos) const;
-    std::shared_ptr<Piece> at(const int x, const int y) const;
+
+    Piece at(const Position& pos) const;
+    Piece at(const int x, const int y) const;
+    const BoardState& getState() const;
+
+    // Castling rights as CastlingRight bits. Rights whose king or rook is not
+    // on its home square are dropped when set.
+    int getCastlingRights() const;
+    void setCastlingRights(int rights);
+
+    // File on which the side to move may capture en passant, or NO_EN_PASSANT.
+    // Setting a file fails, clearing it, unless an enemy pawn can just have
+    // advanced two squares there.
+    int getEnPassantFile() const;
+    bool setEnPassantFile(int file);
+
+    // Zobrist key of the position, kept up to date incrementally by every
+    // change to the board. computeHash() rebuilds it from scratch.
+    uint64_t hash() const;
+    uint64_t computeHash() const;
 
     void setupBoard();
     void clearBoard();
+    bool setFen(const std::string& fen);
     void printBoard() const;
     bool isWhiteTurn() const;
     void setWhiteTurn(bool whiteTurn);
 
-    std::shared_ptr<Piece> removePiece(const Position& pos);
-    void setPiece(const Position& pos, std::shared_ptr<Piece> piece);
+    Piece removePiece(const Position& pos);
+    void setPiece(const Position& pos, Piece piece);
     bool movePiece(const Position& start, const Position& end);
+    // Plays a legal move as a game move, promotion included
+    bool movePiece(const Move& move);
+
+    // Plays a pseudo-legal move and flips the side to move, without checking
+    // that the mover's king is left safe. Every call must be paired with
+    // unmakeMove() in LIFO order.
+    void makeMove(const Move& move);
+    void unmakeMove();
+
+    // Passes the turn without moving, for null-move pruning. Must not be
+    // played while in check and is taken back with unmakeNullMove().
+    void makeNullMove();
+    void unmakeNullMove();
+
+    // Whether the position already occurred since the oldest move still on
+    // the undo stack
+    bool isRepetition() const;
     
+    // Check, checkmate or stalemate of the side to move from one legal move
+    // generation, remembered until the position changes
+    GameStatus status() const;
     bool isCheck(bool isWhite) const;
     bool isCheckmate(bool isWhite) const;
     bool isStalemate(bool isWhite) const;
 
     bool canBeCaptured(const Position &position, const bool isWhite) const;
-    std::vector<playerAction> getPossibleActions(bool isWhite) const;
-    std::pair<Position, Position> getLastMove() const;
+
+    // Static exchange evaluation: the material the side playing move wins,
+    // in Piece::getValue units, once both sides have made every profitable
+    // recapture on its destination. Nothing is played on the board.
+    int see(const Move& move) const;
 };
 
 #endif // BOARD_H
@@ -0,0 +1,91 @@
+#ifndef BOARDSTATE_H
+#define BOARDSTATE_H
+
+#include <cstdint>
+#include <cstring>
+#include "bitboard.h"
+#include "evaluate.h"
+#include "zobrist.h"
+
+// Mailbox encoding of a piece: 0 is an empty square, otherwise bit 3 holds
+// the colour and the low three bits hold the piece type plus one.
+const uint8_t NO_PIECE = 0;
+
+inline uint8_t makePieceCode(Color color, PieceType type) {
+    return uint8_t((color << 3) | (type + 1));
+}
+
+inline PieceType pieceCodeType(uint8_t code) {
+    return PieceType((code & 7) - 1);
+}
+
+inline Color pieceCodeColor(uint8_t code) {
+    return Color(code >> 3);
+}
+
+// Castling rights, one bit per king and side
+enum CastlingRight {
+    WHITE_KING_SIDE = 1, WHITE_QUEEN_SIDE = 2, BLACK_KING_SIDE = 4, BLACK_QUEEN_SIDE = 8,
+    NO_CASTLING = 0, ALL_CASTLING = 15
+};
+
+// Value of BoardState::epFile when the last move was not a double pawn push
+const uint8_t NO_EN_PASSANT = 8;
+
+// Flat, trivially copyable position core. Every piece is recorded both in the
+// bitboard for its colour and type and in the 8x8 mailbox, so set queries and
+// single-square lookups are both O(1). Copying a position is a memcpy.
+// put() and remove() keep the piece part of the Zobrist key up to date, as
+// well as the piece-square sums and game phase read by evaluate(); the side,
+// castling and en passant parts of the key are maintained by Board.
+struct BoardState {
+    Bitboard pieces[2][PIECE_TYPE_NB];
+    Bitboard byColor[2];
+    uint64_t key;
+    int16_t mgScore;    // Sums of psq.mg and psq.eg over the pieces on the board
+    int16_t egScore;
+    int16_t phase;
+    uint8_t mailbox[64];
+    uint8_t castling;   // CastlingRight bits
+    uint8_t epFile;     // File of a pawn that just advanced two squares, or NO_EN_PASSANT
+    bool whiteTurn;
+
+    void clear() {
+        std::memset(this, 0, sizeof(*this));
+        castling = ALL_CASTLING;
+        epFile = NO_EN_PASSANT;
+        whiteTurn = true;
+    }
+
+    Bitboard occupied() const {
+        return byColor[WHITE] | byColor[BLACK];
+    }
+
+    void put(int square, uint8_t code) {
+        Bitboard bit = squareBB(square);
+        pieces[pieceCodeColor(code)][pieceCodeType(code)] |= bit;
+        byColor[pieceCodeColor(code)] |= bit;
+        mailbox[square] = code;
+        key ^= zobrist.piece[code][square];
+        mgScore += psq.mg[code][square];
+        egScore += psq.eg[code][square];
+        phase += psq.phase[code];
+    }
+
+    uint8_t remove(int square) {
+        uint8_t code = mailbox[square];
+        if (code != NO_PIECE) {
+            Bitboard bit = squareBB(square);
+            pieces[pieceCodeColor(code)][pieceCodeType(code)] &= ~bit;
+            byColor[pieceCodeColor(code)] &= ~bit;
+            mailbox[square] = NO_PIECE;
+            key ^= zobrist.piece[code][square];
+            mgScore -= psq.mg[code][square];
+            egScore -= psq.eg[code][square];
+            phase -= psq.phase[code];
+        }
+        return code;
+    }
+};
+
+#endif // BOARDSTATE_H
@@ -0,0 +1,49 @@
+#ifndef BOOK_H
+#define BOOK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "board.h"
+
+// Opening book in the Polyglot .bin format: 16-byte big-endian entries of
+// key, move, weight and learn data, sorted by key. The file is memory-mapped
+// and searched in place, so a lookup reads a few pages and allocates nothing.
+class OpeningBook {
+public:
+    enum Selection { WEIGHTED, BEST };
+
+private:
+    const unsigned char* entries;
+    size_t entryCount;
+    size_t mappedSize;
+    Selection selection;
+    int maxMoves;
+
+public:
+    OpeningBook();
+    ~OpeningBook();
+    OpeningBook(const OpeningBook&) = delete;
+    OpeningBook& operator=(const OpeningBook&) = delete;
+
+    bool open(const std::string& bookPath);
+    void close();
+    bool isOpen() const { return entries != nullptr; }
+
+    // WEIGHTED picks among the book moves with probability proportional to
+    // their weight, BEST always plays the heaviest one
+    void setSelection(Selection mode) { selection = mode; }
+    // Each player leaves the book after this many moves of its own
+    void setMaxMoves(int moves) { maxMoves = moves; }
+    int getMaxMoves() const { return maxMoves; }
+
+    uint64_t polyglotKey(const BoardState& state) const;
+
+    // A legal book move for the position, or Move(0, 0) if it is not in the book
+    Move probe(const Board& board) const;
+};
+
+// The book computer players consult when one is open
+extern OpeningBook openingBook;
+
+#endif // BOOK_H
@@ -14,7 +14,7 @@ public:
     GraphicalDisplay(Board board);
     void drawBoard(const Board &newBoard);
     void updateStatus(const std::string &status);
-    void processEvents();
+    SFMLWindow::Request processEvents();
 };
 
 #endif
@@ -0,0 +1,30 @@
+#ifndef EVALUATE_H
+#define EVALUATE_H
+
+#include <cstdint>
+
+class Board;
+
+// Game phase runs from MAX_PHASE with every minor and major piece on the
+// board down to 0 with only kings and pawns left
+const int MAX_PHASE = 24;
+
+// Material plus piece-square bonus of each piece code on each square, for
+// the middlegame and the endgame, from white's point of view: black pieces
+// score negatively. BoardState adds and subtracts these as pieces are put
+// and removed, so the sums are always current. Built by the compiler.
+struct PieceSquareTables {
+    int16_t mg[16][64];
+    int16_t eg[16][64];
+    int8_t phase[16];
+
+    constexpr PieceSquareTables();
+};
+
+extern const PieceSquareTables psq;
+
+// Static evaluation in centipawns for the side to move: the middlegame and
+// endgame sums blended by game phase
+int evaluate(const Board& board);
+
+#endif // EVALUATE_H
@@ -23,7 +23,6 @@ class Game {
     GameOutcome outcome;
     GraphicalDisplay display;
 
-    void switchTurn();
     bool isGameOver();
 public:
     Game(Board board, std::unique_ptr<Player>&& whitePlayer, std::unique_ptr<Player>&& blackPlayer);
@@ -0,0 +1,57 @@
+#ifndef MOVE_H
+#define MOVE_H
+
+#include <cstdint>
+#include <string>
+#include "bitboard.h"
+
+// Moves that need more than a piece lifted and put down again
+enum MoveFlag { NORMAL_MOVE, PROMOTION, EN_PASSANT, CASTLING };
+
+// A move packed into 16 bits: bits 0-5 hold the origin square, bits 6-11 the
+// destination, bits 12-13 the promotion piece (knight to queen) and bits
+// 14-15 the flag. A castling move is the king's two-square step.
+class Move {
+    uint16_t data;
+
+public:
+    Move() = default;
+    Move(int from, int to, MoveFlag flag = NORMAL_MOVE)
+        : data(uint16_t(from | (to << 6) | (flag << 14))) {}
+    // promotion names the piece a pawn reaching the last rank turns into;
+    // PAWN means the move is not a promotion
+    Move(int from, int to, PieceType promotion)
+        : data(promotion == PAWN ? uint16_t(from | (to << 6))
+                                 : uint16_t(from | (to << 6) | ((promotion - KNIGHT) << 12) | (PROMOTION << 14))) {}
+    Move(const Position& start, const Position& end)
+        : Move(squareOf(start), squareOf(end)) {}
+
+    static Move fromRaw(uint16_t data) {
+        Move move;
+        move.data = data;
+        return move;
+    }
+
+    int from() const { return data & 63; }
+    int to() const { return (data >> 6) & 63; }
+    MoveFlag flag() const { return MoveFlag(data >> 14); }
+    bool isPromotion() const { return flag() == PROMOTION; }
+    PieceType promotion() const { return isPromotion() ? PieceType(((data >> 12) & 3) + KNIGHT) : PAWN; }
+    uint16_t raw() const { return data; }
+
+    // Coordinate notation, e.g. "e2e4" or "e7e8q"
+    std::string toString() const {
+        std::string text = {char('a' + (from() & 7)), char('1' + (from() >> 3)), char('a' + (to() & 7)), char('1' + (to() >> 3))};
+        if (isPromotion()) {
+            text += "pnbrqk"[promotion()];
+        }
+        return text;
+    }
+
+    bool operator==(const Move& other) const { return data == other.data; }
+    bool operator!=(const Move& other) const { return data != other.data; }
+};
+
+static_assert(sizeof(Move) == 2, "Moves must stay packed into 16 bits");
+
+#endif // MOVE_H
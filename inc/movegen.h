@@ -0,0 +1,44 @@
+#ifndef MOVEGEN_H
+#define MOVEGEN_H
+
+#include "boardstate.h"
+#include "move.h"
+
+// Fixed-capacity list of moves, meant to live on the caller's stack. 256 is
+// comfortably above the largest number of legal moves in any chess position.
+struct MoveList {
+    static const int CAPACITY = 256;
+
+    Move moves[CAPACITY];
+    int count;
+
+    MoveList() : count(0) {}
+
+    void push(const Move& move) { moves[count++] = move; }
+    void clear() { count = 0; }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    const Move& operator[](int i) const { return moves[i]; }
+    const Move* begin() const { return moves; }
+    const Move* end() const { return moves + count; }
+};
+
+// Which legal moves to generate. CAPTURES also takes in en passant and every
+// promotion, QUIETS everything else, so the two split LEGAL between them.
+enum GenType { CAPTURES, QUIETS, LEGAL };
+
+// True for a move that neither captures nor promotes
+inline bool isQuiet(const BoardState& state, const Move& move) {
+    return state.mailbox[move.to()] == NO_PIECE && move.flag() != EN_PASSANT && !move.isPromotion();
+}
+
+// All pieces of either colour that attack square, given the occupancy
+Bitboard attackersTo(const BoardState& state, int square, Bitboard occupied);
+
+// Emits every fully legal move of the given kind for side us, including
+// castling, en passant and one move per promotion piece. Checkers and pinned
+// pieces are computed once up front, so no move has to be played to test it.
+void generateLegalMoves(const BoardState& state, Color us, MoveList& list, GenType type = LEGAL);
+
+#endif // MOVEGEN_H
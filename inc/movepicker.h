@@ -0,0 +1,58 @@
+#ifndef MOVEPICKER_H
+#define MOVEPICKER_H
+
+#include "movegen.h"
+
+// Butterfly history, indexed by side, origin and destination: how often a
+// quiet move has recently caused a beta cutoff
+typedef int ButterflyHistory[2][64][64];
+
+// Keeps a history score within +-HISTORY_MAX, so old cutoffs fade as new ones
+// are added
+const int HISTORY_MAX = 16384;
+
+inline void updateHistory(int& entry, int bonus) {
+    entry += bonus - entry * (bonus < 0 ? -bonus : bonus) / HISTORY_MAX;
+}
+
+// Hands out the legal moves of a position one at a time, most promising
+// first: the hash move, captures by most valuable victim then least valuable
+// attacker, the killer moves of this ply, then the remaining quiet moves by
+// history. Each stage is generated and sorted only once the previous one is
+// used up, so a cutoff early on skips the rest of the work.
+class MovePicker {
+    enum Stage { HASH_MOVE, GENERATE_CAPTURES, PICK_CAPTURES, KILLERS, SCORE_QUIETS, PICK_QUIETS, DONE };
+
+    const BoardState& state;
+    Color us;
+    Move hashMove;
+    Move killers[2];
+    const ButterflyHistory& history;
+    Stage stage;
+    int killerIndex;
+
+    MoveList captures;
+    MoveList quiets;
+    int captureScores[MoveList::CAPACITY];
+    int quietScores[MoveList::CAPACITY];
+    int nextCapture;
+    int nextQuiet;
+    bool capturesGenerated;
+    bool quietsGenerated;
+    bool capturesOnly;
+
+    void generateCaptures();
+    void generateQuiets();
+
+public:
+    // killers holds the two killer moves of this ply; any of the moves passed
+    // in may be Move(0, 0) or illegal here, and is then skipped
+    MovePicker(const BoardState& state, Move hashMove, const Move* killers, const ButterflyHistory& history);
+    // Only the captures and promotions, for the quiescence search
+    MovePicker(const BoardState& state, const ButterflyHistory& history);
+
+    // The next move to try, or Move(0, 0) once every legal move was returned
+    Move next();
+};
+
+#endif // MOVEPICKER_H
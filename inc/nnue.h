@@ -0,0 +1,66 @@
+#ifndef NNUE_H
+#define NNUE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "boardstate.h"
+#include "move.h"
+
+// Efficiently updatable neural network evaluation. The network is
+// (768 -> NNUE_HIDDEN) x 2 -> 1: one input per colour, piece type and square,
+// a hidden layer computed once from each side's point of view, and an output
+// neuron reading the side to move's half first. The hidden layer sums are the
+// accumulator. A move changes at most four inputs, so the accumulator of a
+// child position is its parent's plus and minus a few weight rows.
+const int NNUE_INPUTS = 768;
+const int NNUE_HIDDEN = 256;
+
+// Hidden layer sums for each point of view, indexed by Color
+struct Accumulator {
+    int16_t values[2][NNUE_HIDDEN];
+};
+
+// The pieces one move puts down and lifts up, as (code, square) pairs
+struct DirtyPieces {
+    int addedCount;
+    int removedCount;
+    uint8_t added[2][2];
+    uint8_t removed[2][2];
+};
+
+// What move changes on the board, worked out before it is played
+DirtyPieces dirtyPiecesOf(const BoardState& before, const Move& move);
+
+// Quantized network weights. A weights file holds, as little-endian int16:
+// the input weights [768][NNUE_HIDDEN], the hidden biases [NNUE_HIDDEN], the
+// output weights [2 * NNUE_HIDDEN] and the output bias. Inputs are numbered
+// relative to the point of view: 384 * (piece is theirs) + 64 * type +
+// square, with the board flipped vertically for black. This is the layout
+// trainers such as bullet write for a simple 768-input network.
+class Network {
+    struct Weights;
+    std::unique_ptr<Weights> weights;
+
+public:
+    Network();
+    ~Network();
+
+    // Replaces the current weights; on failure the old ones stay loaded
+    bool load(const std::string& path);
+    void unload();
+    bool loaded() const { return weights != nullptr; }
+
+    void refresh(const BoardState& state, Accumulator& accumulator) const;
+    void update(const Accumulator& parent, const DirtyPieces& dirty, Accumulator& child) const;
+    // Centipawns for the side to move
+    int evaluate(const Accumulator& accumulator, Color sideToMove) const;
+
+    // Name of the SIMD kernels picked for this CPU
+    static const char* kernelName();
+};
+
+// The network the search evaluates with when one is loaded
+extern Network network;
+
+#endif // NNUE_H
@@ -1,99 +1,42 @@
 #ifndef PIECES_H
 #define PIECES_H
 
-#include <iostream>
-#include <vector>
-#include <memory>
+#include <string>
 #include "position.h"
+#include "boardstate.h"
 
 class Board;
 
-// Abstract class for chess pieces
+// A chess piece as a one-byte value: the mailbox code of its colour and type.
+// A default constructed Piece is the empty square and tests false. Behaviour
+// that differs by type is looked up in per-type tables, so pieces need no
+// heap objects, virtual calls or casts.
 class Piece {
-protected:
-    char symbol;
-    bool isWhite;
-    int value;
+    uint8_t code;
+
 public:
-    Piece(char symbol, bool isWhite, int value);
-    virtual ~Piece();
-    virtual std::shared_ptr<Piece> clone() const = 0;
+    Piece() : code(NO_PIECE) {}
+    explicit Piece(uint8_t code) : code(code) {}
+    Piece(PieceType type, bool isWhite) : code(makePieceCode(isWhite ? WHITE : BLACK, type)) {}
 
-    virtual bool isValidMove(const Position& start, const Position& end, const Board& board) const = 0;
-    virtual void move(const Position& start, const Position& end, Board& board);
+    // Piece for a letter such as 'K' or 'p', or no piece
+    static Piece fromSymbol(char symbol);
 
-    virtual std::vector<Position> getValidMoves(const Position& start, const Board& board) const;
+    explicit operator bool() const { return code != NO_PIECE; }
+    bool operator==(const Piece& other) const { return code == other.code; }
+    bool operator!=(const Piece& other) const { return code != other.code; }
 
     char getSymbol() const;
-    bool getIsWhite() const;
+    bool getIsWhite() const { return pieceCodeColor(code) == WHITE; }
     int getValue() const;
+    PieceType getType() const { return pieceCodeType(code); }
+    uint8_t getCode() const { return code; }
 };
 
-bool isWithinBounds(const Position& pos);
-
-bool isPathClear(const Board& board, const Position& start, const Position& end);
-
-// King
-class King : public Piece {
-    bool hasMoved;
-public:
-    King(bool isWhite);
-    std::shared_ptr<Piece> clone() const override;
-
-    bool isValidMove(const Position& start, const Position& end, const Board& board) const override;
-    void move(const Position& start, const Position& end, Board& board) override;
-};
-
-// Queen
-class Queen : public Piece {
-public:
-    Queen(bool isWhite);
-    std::shared_ptr<Piece> clone() const override;
-
-    bool isValidMove(const Position& start, const Position& end, const Board& board) const override;
-};
-
-// Rook
-class Rook : public Piece {
-    bool hasMoved;
-public:
-    Rook(bool isWhite);
-    std::shared_ptr<Piece> clone() const override;
-
-    bool isValidMove(const Position& start, const Position& end, const Board& board) const override;
-    void move(const Position& start, const Position& end, Board& board) override;
-
-    bool getHasMoved() const;
-};
-
-// Bishop
-class Bishop : public Piece {
-public:
-    Bishop(bool isWhite);
-    std::shared_ptr<Piece> clone() const override;
+static_assert(sizeof(Piece) == 1, "Pieces must stay one byte");
 
-    bool isValidMove(const Position& start, const Position& end, const Board& board) const override;
-};
-
-// Knight
-class Knight : public Piece {
-public:
-    Knight(bool isWhite);
-    std::shared_ptr<Piece> clone() const override;
-
-    bool isValidMove(const Position& start, const Position& end, const Board& board) const override;
-};
-
-// Pawn
-class Pawn : public Piece {
-    bool hasMoved;
-public:
-    Pawn(bool isWhite);
-    std::shared_ptr<Piece> clone() const override;
-
-    bool isValidMove(const Position& start, const Position& end, const Board& board) const override;
-    void move(const Position& start, const Position& end, Board& board) override;
-    void promote(const Position& end, Board& board, const std::string& promotion);
-};
+// Replaces the pawn that just reached the last rank with the piece named by
+// promotion ("Q", "R", "B" or "N"), defaulting to a queen
+void promotePawn(const Position& end, Board& board, const std::string& promotion);
 
 #endif // PIECES_H
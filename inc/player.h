@@ -1,36 +1,83 @@
 #ifndef PLAYER_H
 #define PLAYER_H
 
+#include <chrono>
+#include <functional>
+#include <future>
 #include <vector>
 #include <memory>
 #include "position.h"
+#include "search.h"
+#include "tt.h"
 
 // Forward declaration
 class Board;
 class Piece;
 
+// What the game can ask of a computer player while it searches: carry on,
+// play the best move found so far, or drop the search and wait for a new
+// command
+enum class SearchInterrupt { None, MoveNow, Abort };
+
 class Player {
 protected:
     bool isWhite;
+    // Called every few milliseconds while a computer player searches
+    std::function<SearchInterrupt()> idleHandler;
 public:
     Player(bool isWhite) : isWhite(isWhite) {}
     virtual ~Player() = default;
 
     virtual bool makeAction(Board& board) = 0;
+
+    void setIdleHandler(const std::function<SearchInterrupt()>& handler) { idleHandler = handler; }
+
+    // Whether makeAction waits for a person, leaving the opponent time to ponder
+    virtual bool isHuman() const { return false; }
+
+    // Called when the opponent starts thinking about its move in board, and
+    // again with the new position once it has moved
+    virtual void ponder(const Board&) {}
+    virtual void stopPondering(const Board&) {}
 };
 
 class HumanPlayer : public Player {
 public:
     HumanPlayer(bool isWhite) : Player(isWhite) {}
     bool makeAction(Board& board) override;
+    bool isHuman() const override { return true; }
 };
 
 class ComputerPlayer : public Player {
     int difficulty;
+    int threads;
+    int movesPlayed;
+    TranspositionTable tt;  // Only allocated for the searching levels
+
+    // Pondering: while the opponent thinks, the searching levels search the
+    // position after the reply their last search expected, sharing the table.
+    // If the opponent plays it the result is kept for the next move.
+    Move expectedReply;
+    std::unique_ptr<Search> ponderSearch;
+    std::future<SearchResult> pondering;
+    uint64_t ponderKey;
+    std::chrono::steady_clock::time_point ponderStart;
+    SearchResult ponderResult;
+    int ponderHitMs;  // Time spent on the position now on the board, 0 after a miss
+
+    void endPondering();
 
 public:
-    ComputerPlayer(bool isWhite, int difficulty) : Player(isWhite), difficulty(difficulty) {}
+    static const int DEFAULT_HASH_MB = 16;
+
+    // threads and hashMB only matter to the searching levels
+    ComputerPlayer(bool isWhite, int difficulty, int threads = 1, int hashMB = DEFAULT_HASH_MB)
+        : Player(isWhite), difficulty(difficulty), threads(threads), movesPlayed(0), tt(difficulty >= 5 ? hashMB : 0),
+          expectedReply(0, 0), ponderKey(0), ponderHitMs(0) {}
+    ~ComputerPlayer() override;
     bool makeAction(Board& board) override;
+    void ponder(const Board& board) override;
+    void stopPondering(const Board& board) override;
 };
 
 #endif // PLAYER_H
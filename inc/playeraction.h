@@ -1,28 +1,40 @@
 #ifndef PLAYERACTION_H
 #define PLAYERACTION_H
 
-#include "position.h"
-#include "pieces.h"
-
-struct playerAction {
-    Position start;
-    Position end;
-    Piece* piece;
-    Piece* captured;
-    bool isCapture;
-    bool canBeCaptured;
-    bool isCheck;
-    bool isCheckmate;
-    int score;
-
-    playerAction(Position start, Position end, Piece* piece, Piece* captured, bool isCapture, bool canBeCaptured, bool isCheck, bool isCheckmate)
-        : start(start), end(end), piece(piece), captured(captured), isCapture(isCapture), canBeCaptured(canBeCaptured), isCheck(isCheck), isCheckmate(isCheckmate) {
-            score = piece->getValue() + (captured ? captured->getValue() : 0);
-        }
-    
-    playerAction() : start(Position()), end(Position()), piece(nullptr), captured(nullptr), isCapture(false), canBeCaptured(false), isCheck(false), isCheckmate(false) {}
-};
+#include "board.h"
+#include "move.h"
+#include "movegen.h"
 
-#endif // PLAYERACTION_H
+// The legal moves of one side, annotated for the computer players. Each
+// annotation is worked out the first time it is asked for and then cached,
+// so a caller only pays for the ones it reads. Pawns always promote to a
+// queen.
+class PlayerActions {
+    enum Annotation : uint8_t { CAPTURE = 1, GIVES_CHECK = 2, LOSES_MATERIAL = 4, MATE = 8 };
+
+    Board scratch;
+    bool isWhite;
+    MoveList moves;
+    uint8_t known[MoveList::CAPACITY];
+    uint8_t flags[MoveList::CAPACITY];
+
+    bool annotation(int i, Annotation annotation);
+
+public:
+    PlayerActions(const Board& board, bool isWhite);
 
+    int size() const { return moves.size(); }
+    bool empty() const { return moves.empty(); }
+    const Move& operator[](int i) const { return moves[i]; }
 
+    bool isCapture(int i);
+    bool givesCheck(int i);
+    // The exchange the move starts on its destination loses material
+    bool losesMaterial(int i);
+    bool isMate(int i);
+
+    // Value of the moving piece plus the value of the piece it takes
+    int score(int i) const;
+};
+
+#endif // PLAYERACTION_H
@@ -1,6 +1,8 @@
 #ifndef POSITION_H
 #define POSITION_H
 
+#include <functional>
+
 struct Position {
     int x, y;
     Position() : x(0), y(0) {}
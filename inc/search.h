@@ -0,0 +1,144 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <vector>
+#include "board.h"
+#include "evaluate.h"
+#include "movepicker.h"
+#include "nnue.h"
+#include "tablebase.h"
+#include "tt.h"
+
+const int MAX_PLY = 64;
+const int INFINITE_SCORE = 32001;
+// Being mated n plies from the root scores -(MATE_SCORE - n)
+const int MATE_SCORE = 32000;
+const int MATE_BOUND = MATE_SCORE - MAX_PLY;
+
+// Limits on one search; zero means no limit. The search stops at whichever
+// limit is reached first.
+struct SearchLimits {
+    int depth = 0;
+    uint64_t nodes = 0;
+    int timeMs = 0;
+};
+
+// Selective search techniques, each of which can be switched off to measure
+// what it is worth
+struct SearchOptions {
+    bool nullMove = true;
+    bool lateMoveReductions = true;
+    bool futility = true;
+    bool reverseFutility = true;
+};
+
+// Outcome of the deepest completed iteration. score is in centipawns from
+// the point of view of the side to move.
+struct SearchResult {
+    Move bestMove = Move(0, 0);
+    int score = 0;
+    int depth = 0;
+    uint64_t nodes = 0;
+    std::vector<Move> pv;
+};
+
+class Search;
+
+// One thread of a search, with its own copy of the position and its own
+// principal variation
+class SearchWorker {
+    Search& search;
+    int id;
+    Board board;
+    std::atomic<uint64_t> nodes;
+
+    // Triangular principal variation table: pv[ply] holds the best line
+    // found from ply onwards
+    Move pv[MAX_PLY][MAX_PLY];
+    int pvLength[MAX_PLY];
+    Move previousPv[MAX_PLY];
+    int previousPvLength;
+    bool followPv;
+
+    // Move ordering: two quiet moves per ply that last caused a cutoff there,
+    // and the history of quiet cutoffs anywhere
+    Move killers[MAX_PLY][2];
+    ButterflyHistory history;
+
+    // Network accumulators by ply, with the pieces each move changed, when a
+    // network is loaded
+    bool useNetwork;
+    Accumulator accumulators[MAX_PLY + 1];
+    bool accumulatorReady[MAX_PLY + 1];
+    DirtyPieces dirty[MAX_PLY];
+
+    void makeMove(const Move& move, int ply);
+    void makeNullMove(int ply);
+    int staticEval(int ply);
+
+    // Counts the node and clears its principal variation; false once the
+    // search has been stopped
+    bool enterNode(int ply);
+    // allowNull is false right after a null move and in the search that
+    // verifies a null move cut
+    int negamax(int depth, int ply, int alpha, int beta, bool allowNull = true);
+    // Resolves captures at the horizon, so leaves are evaluated in quiet
+    // positions
+    int quiesce(int ply, int alpha, int beta);
+
+public:
+    SearchResult result;
+
+    SearchWorker(Search& search, int id) : search(search), id(id), nodes(0) {}
+
+    // Deepens until the search stops. Odd-numbered helpers start one ply
+    // deeper, so the threads spread over neighbouring depths.
+    void iterate(const Board& position);
+    uint64_t nodeCount() const { return nodes.load(std::memory_order_relaxed); }
+};
+
+// Negamax alpha-beta with iterative deepening. Each iteration searches the
+// previous principal variation first, and an iteration cut short by the
+// budget is thrown away. Results are kept in a transposition table that
+// outlives the search, so the next move starts from what this one learned.
+//
+// With more than one thread the search is Lazy SMP: every worker searches
+// the same root and they cooperate only through the shared table. The
+// calling thread is the main worker; it alone watches the budget, and its
+// result is the one returned.
+class Search {
+    friend class SearchWorker;
+
+    TranspositionTable& tt;
+    int threadCount;
+    SearchLimits limits;
+    SearchOptions options;
+    std::chrono::steady_clock::time_point start;
+    std::atomic<bool> stopped;
+    std::atomic<bool> stopRequested;
+    std::vector<std::unique_ptr<SearchWorker>> workers;
+
+    uint64_t totalNodes() const;
+    bool outOfBudget() const;
+
+public:
+    explicit Search(TranspositionTable& tt, int threads = 1);
+
+    void setOptions(const SearchOptions& searchOptions) { options = searchOptions; }
+
+    SearchResult run(const Board& position, const SearchLimits& limits);
+    // run() on a thread of its own, returning at once. The future is ready
+    // when the search ends by itself or after stop(); destroying it waits.
+    std::future<SearchResult> runAsync(const Board& position, const SearchLimits& limits);
+
+    // Ends the running search from another thread, or the next one to start
+    // if none is running; run() then returns its deepest completed iteration
+    void stop();
+};
+
+#endif // SEARCH_H
@@ -8,7 +8,6 @@ class SetupManager {
     Board board;
     bool validateSetup() const;
     void processSetupCommand(const std::string& command);
-    std::shared_ptr<Piece> createPiece(char pieceChar);
 
 public:
     SetupManager();
@@ -0,0 +1,116 @@
+#ifndef TABLEBASE_H
+#define TABLEBASE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "board.h"
+
+// Endgame tables of up to four pieces, kings included, giving every position
+// of one material set as won, drawn or lost for the side to move with the
+// distance to mate. tools/tbgen.cc builds them by retrograde analysis. Tables
+// only cover positions without castling rights. Positions with an en passant
+// capture available aren't stored: they are scored through their moves.
+const int TB_MAX_PIECES = 4;
+
+// One byte per position: TB_DRAW, TB_INVALID for positions that can't occur
+// (the side not to move in check, a pawn on its first or last rank), or the
+// distance to mate in plies plus one. An odd distance is a win for the side
+// to move, an even one a loss: 0 means it is checkmated.
+const uint8_t TB_DRAW = 0;
+const uint8_t TB_UNKNOWN = 254;  // Only while generating
+const uint8_t TB_INVALID = 255;
+const int TB_MAX_DISTANCE = 252;
+
+// A table file is this tag followed by one byte per index
+extern const char TB_MAGIC[8];
+
+// Outcome for the side to move: 1 win, 0 draw, -1 loss
+struct TBResult {
+    int outcome;
+    int pliesToMate;
+};
+
+// A material set such as "KQvKR", white's pieces first, and how its positions
+// are numbered. The index is, most significant first: the side to move, the
+// white king's square folded into a corner by symmetry (a1-d4 below the
+// diagonal without pawns, the a-d files with them), then 64 squares per
+// other piece. Pieces are listed white king, white pieces from queen down,
+// black king, black pieces from queen down.
+struct TBMaterial {
+    std::string name;
+    int count;
+    uint8_t codes[TB_MAX_PIECES];
+    bool hasPawns;
+    size_t size;
+
+    static bool parse(const std::string& name, TBMaterial& material);
+
+    // The position's index, reading black's pieces as white's when flip is
+    // set. False unless the position has exactly this material.
+    bool indexOf(const BoardState& state, bool flip, size_t& index) const;
+    // The position at index, false if two pieces share a square or a pawn
+    // stands on a back rank
+    bool positionAt(size_t index, BoardState& state) const;
+};
+
+// Counts of each piece code, four bits each: equal for positions with the
+// same material
+uint64_t materialSignature(const BoardState& state);
+uint64_t materialSignature(const TBMaterial& material);
+
+// The position after a move, without castling rights. A double pawn push
+// leaves its en passant file.
+BoardState positionAfter(const BoardState& state, const Move& move);
+
+// True when the side to move has a legal en passant capture
+bool enPassantAvailable(const BoardState& state);
+
+// The value of the position from the values after each of its legal moves,
+// which valueAfter gives from the point of view of the side then to move.
+// TB_UNKNOWN if that decides nothing yet, TB_INVALID if a value is missing.
+uint8_t valueByMoves(const BoardState& state, const std::function<uint8_t(const Move&)>& valueAfter);
+
+// The tables loaded from disk, memory-mapped
+class Tablebases {
+    struct Table {
+        TBMaterial material;
+        uint64_t signature;
+        const uint8_t* values;
+        size_t mappedSize;
+    };
+
+    std::vector<Table> tables;
+    int largest;
+
+public:
+    Tablebases() : largest(0) {}
+    ~Tablebases();
+    Tablebases(const Tablebases&) = delete;
+    Tablebases& operator=(const Tablebases&) = delete;
+
+    // Maps one table file, named after its material as in "KQvKR.tb"
+    bool add(const std::string& path);
+    // Maps every table file in directory and returns how many were found
+    int load(const std::string& directory);
+    void clear();
+
+    // Most pieces of any loaded table, 0 when none is loaded
+    int maxPieces() const { return largest; }
+
+    // The stored byte for the position, false when no table covers it. A
+    // position with bare kings is a draw, and one with an en passant capture
+    // available is scored through its moves.
+    bool probeValue(const BoardState& state, uint8_t& value) const;
+    bool probe(const BoardState& state, TBResult& result) const;
+
+    // The fastest win, a draw, or the slowest loss, and its outcome. False
+    // unless every move leads into a loaded table.
+    bool probeRoot(const BoardState& state, Move& best, TBResult& result) const;
+};
+
+extern Tablebases tablebases;
+
+#endif // TABLEBASE_H
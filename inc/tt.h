@@ -0,0 +1,72 @@
+#ifndef TT_H
+#define TT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "move.h"
+
+// How a stored score relates to the true score of the position
+enum Bound : uint8_t { BOUND_NONE, BOUND_UPPER, BOUND_LOWER, BOUND_EXACT };
+
+// What the table remembers about a position
+struct TTData {
+    Move move;
+    int score;
+    int depth;
+    Bound bound;
+};
+
+// Fixed-size table of search results, shared by every search thread without
+// locks. An entry is two 64-bit words: the packed data, and the key XORed
+// with it. A probe only accepts an entry whose words XOR back to the key, so
+// an entry torn by two threads writing at once reads as a miss instead of as
+// another position's result. Four entries fill one 64-byte bucket, so a
+// probe touches a single cache line.
+class TranspositionTable {
+    struct Entry {
+        std::atomic<uint64_t> check;
+        std::atomic<uint64_t> data;
+    };
+
+    struct Bucket {
+        Entry entries[4];
+    };
+
+    static_assert(sizeof(Bucket) == 64, "A bucket must fill exactly one cache line");
+
+    std::unique_ptr<char[]> memory;
+    Bucket* buckets;
+    size_t bucketMask;
+    uint8_t generation;
+
+    Bucket& bucketOf(uint64_t key) const {
+        return buckets[key & bucketMask];
+    }
+
+public:
+    TranspositionTable();
+    explicit TranspositionTable(size_t megabytes);
+
+    // Rounds down to a power of two number of buckets and clears the table
+    void resize(size_t megabytes);
+    void clear();
+    bool empty() const { return buckets == nullptr; }
+
+    // Called once per search, so results of earlier searches are the first
+    // to be replaced
+    void newSearch();
+
+    // Starts loading the bucket of key into the cache ahead of a probe
+    void prefetch(uint64_t key) const {
+        if (buckets) {
+            __builtin_prefetch(&bucketOf(key));
+        }
+    }
+
+    bool probe(uint64_t key, TTData& data) const;
+    void store(uint64_t key, Move move, int score, int depth, Bound bound);
+};
+
+#endif // TT_H
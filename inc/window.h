@@ -17,10 +17,14 @@ public:
 
     enum {White=0, Black, Red, Green, Blue}; // Available colours.
 
+    // Keys pressed while the computer thinks: Space to move now, Escape to
+    // abort the search.
+    enum Request {NoRequest=0, MoveNow, AbortSearch};
+
     void fillRectangle(int x, int y, int width, int height, int colour=Black);
     void drawString(int x, int y, std::string msg, int colour=Black);
     void drawPeice(int x, int y, char piece, int colour);
-    void processEvents();
+    Request processEvents();  // Returns the last request made since the previous call.
     void clear(int colour);
     void display();
 };
@@ -0,0 +1,20 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <cstdint>
+
+// Random keys XORed together to give each position a 64-bit signature.
+// Pieces are indexed by their mailbox code; the table is built by the
+// compiler from a fixed seed, so keys are identical across runs and builds.
+struct ZobristKeys {
+    uint64_t piece[16][64];
+    uint64_t side;          // Present when black is to move
+    uint64_t castling[16];  // Indexed by the 4-bit castling rights
+    uint64_t enPassant[8];  // Indexed by file
+
+    constexpr ZobristKeys();
+};
+
+extern const ZobristKeys zobrist;
+
+#endif // ZOBRIST_H
@@ -0,0 +1,157 @@
+#include "attacks.h"
+
+static constexpr int rookDirections[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+static constexpr int bishopDirections[4][2] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+
+static constexpr bool onBoard(int x, int y) {
+    return x >= 0 && x < 8 && y >= 0 && y < 8;
+}
+
+static constexpr Bitboard stepBB(int square, int dx, int dy) {
+    return onBoard((square & 7) + dx, (square >> 3) + dy) ? Bitboard(1) << (square + dy * 8 + dx) : 0;
+}
+
+constexpr LeaperAttacks::LeaperAttacks() : knight(), king(), pawn() {
+    constexpr int knightSteps[8][2] = {{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
+    constexpr int kingSteps[8][2] = {{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}};
+
+    for (int square = 0; square < 64; ++square) {
+        for (int i = 0; i < 8; ++i) {
+            knight[square] |= stepBB(square, knightSteps[i][0], knightSteps[i][1]);
+            king[square] |= stepBB(square, kingSteps[i][0], kingSteps[i][1]);
+        }
+        pawn[WHITE][square] = stepBB(square, -1, 1) | stepBB(square, 1, 1);
+        pawn[BLACK][square] = stepBB(square, -1, -1) | stepBB(square, 1, -1);
+    }
+}
+
+constexpr LineTables::LineTables() : between(), line() {
+    for (int a = 0; a < 64; ++a) {
+        for (int d = 0; d < 8; ++d) {
+            int dx = d < 4 ? rookDirections[d][0] : bishopDirections[d - 4][0];
+            int dy = d < 4 ? rookDirections[d][1] : bishopDirections[d - 4][1];
+
+            // The full line through a in this direction, both ways
+            Bitboard full = Bitboard(1) << a;
+            for (int sign = -1; sign <= 1; sign += 2) {
+                for (int x = (a & 7) + sign * dx, y = (a >> 3) + sign * dy; onBoard(x, y); x += sign * dx, y += sign * dy) {
+                    full |= Bitboard(1) << (y * 8 + x);
+                }
+            }
+
+            Bitboard path = 0;
+            for (int x = (a & 7) + dx, y = (a >> 3) + dy; onBoard(x, y); x += dx, y += dy) {
+                int b = y * 8 + x;
+                between[a][b] = path;
+                line[a][b] = full;
+                path |= Bitboard(1) << b;
+            }
+        }
+    }
+}
+
+constexpr LeaperAttacks leaperAttacks;
+constexpr LineTables lineTables;
+
+Magic rookMagics[64];
+Magic bishopMagics[64];
+
+static Bitboard rookTable[0x19000];
+static Bitboard bishopTable[0x1480];
+
+// Ray walk used only to fill the lookup tables
+static Bitboard slidingAttacks(int square, Bitboard occupied, const int directions[4][2]) {
+    Bitboard attacks = 0;
+    for (int d = 0; d < 4; ++d) {
+        int x = (square & 7) + directions[d][0];
+        int y = (square >> 3) + directions[d][1];
+        while (onBoard(x, y)) {
+            Bitboard bit = squareBB(squareOf(x, y));
+            attacks |= bit;
+            if (occupied & bit) break;
+            x += directions[d][0];
+            y += directions[d][1];
+        }
+    }
+    return attacks;
+}
+
+#ifndef USE_PEXT
+// xorshift64* generator; fixed seeds keep the magics identical on every run
+static Bitboard nextRandom(Bitboard& seed) {
+    seed ^= seed >> 12;
+    seed ^= seed << 25;
+    seed ^= seed >> 27;
+    return seed * 2685821657736338717ULL;
+}
+#endif
+
+// Finds a magic multiplier for every square by trial and error and fills the
+// shared attack table. Magics with few set bits are tried since they tend to
+// work. With PEXT the occupancy bits index the table directly.
+static void initMagics(Magic magics[64], Bitboard table[], const int directions[4][2]) {
+    Bitboard reference[4096];
+#ifndef USE_PEXT
+    Bitboard occupancy[4096];
+    int epoch[4096] = {};
+    // Per-rank seeds that are known to find every magic quickly
+    static const Bitboard seeds[8] = {728, 10316, 55013, 32803, 12281, 15100, 16645, 255};
+    int attempt = 0;
+#endif
+    Bitboard* next = table;
+
+    for (int square = 0; square < 64; ++square) {
+        Magic& m = magics[square];
+
+        // Edge squares don't change the attack set, so they stay out of the mask
+        Bitboard edges = ((0xFFULL | (0xFFULL << 56)) & ~(0xFFULL << (8 * (square >> 3))))
+                       | ((0x0101010101010101ULL | (0x8080808080808080ULL)) & ~(0x0101010101010101ULL << (square & 7)));
+        m.mask = slidingAttacks(square, 0, directions) & ~edges;
+        m.shift = 64 - popCount(m.mask);
+        m.attacks = next;
+
+        // Enumerate every subset of the mask (Carry-Rippler)
+        int size = 0;
+        Bitboard subset = 0;
+        do {
+            reference[size] = slidingAttacks(square, subset, directions);
+#ifdef USE_PEXT
+            m.attacks[_pext_u64(subset, m.mask)] = reference[size];
+#else
+            occupancy[size] = subset;
+#endif
+            size++;
+            subset = (subset - m.mask) & m.mask;
+        } while (subset);
+        next += size;
+
+#ifndef USE_PEXT
+        Bitboard seed = seeds[square >> 3];
+        for (int i = 0; i < size; ) {
+            do {
+                m.magic = nextRandom(seed) & nextRandom(seed) & nextRandom(seed);
+            } while (popCount((m.magic * m.mask) >> 56) < 6);
+
+            // A magic works if no two occupancies with different attacks share an index
+            ++attempt;
+            for (i = 0; i < size; ++i) {
+                unsigned index = m.index(occupancy[i]);
+                if (epoch[index] < attempt) {
+                    epoch[index] = attempt;
+                    m.attacks[index] = reference[i];
+                } else if (m.attacks[index] != reference[i]) {
+                    break;
+                }
+            }
+        }
+#endif
+    }
+}
+
+// Fills the slider tables during static initialisation, before main() runs
+static struct SliderTables {
+    SliderTables() {
+        initMagics(rookMagics, rookTable, rookDirections);
+        initMagics(bishopMagics, bishopTable, bishopDirections);
+    }
+} sliderTables;
@@ -1,81 +1,228 @@
 #include "board.h"
-#include <unordered_set>
+#include "attacks.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <unordered_map>
+#include <type_traits>
 #include <iostream>
+#include <sstream>
+#include <cctype>
+
+static_assert(std::is_trivially_copyable<BoardState>::value, "Position copies must stay a memcpy");
+
+// Rights that survive a move starting or ending on square. Moving the king
+// gives up both sides; moving or capturing a rook gives up its side.
+static int castlingMask(int square) {
+    switch (square) {
+        case 0:  return ALL_CASTLING & ~WHITE_QUEEN_SIDE;
+        case 4:  return ALL_CASTLING & ~(WHITE_KING_SIDE | WHITE_QUEEN_SIDE);
+        case 7:  return ALL_CASTLING & ~WHITE_KING_SIDE;
+        case 56: return ALL_CASTLING & ~BLACK_QUEEN_SIDE;
+        case 60: return ALL_CASTLING & ~(BLACK_KING_SIDE | BLACK_QUEEN_SIDE);
+        case 63: return ALL_CASTLING & ~BLACK_KING_SIDE;
+        default: return ALL_CASTLING;
+    }
+}
 
-Board::Board() : squares(8, std::vector<std::shared_ptr<Piece>>(8, nullptr)), whiteTurn(true), lastMove({Position(0, 0), Position(0, 0)}) {}
-
-Board::Board(const Board& other) : squares(8, std::vector<std::shared_ptr<Piece>>(8, nullptr)) {
-    for (int y = 0; y < 8; ++y) {
-        for (int x = 0; x < 8; ++x) {
-            if (other.squares[y][x]) {
-                squares[y][x] = other.squares[y][x]->clone(); // Ensure each piece is also copied
-            }
+// Rights whose king and rook stand on their home squares
+static int possibleCastlingRights(const BoardState& state) {
+    int rights = NO_CASTLING;
+    for (Color color : {WHITE, BLACK}) {
+        int home = color == WHITE ? 0 : 56;
+        if (state.mailbox[home + 4] != makePieceCode(color, KING)) continue;
+        if (state.mailbox[home + 7] == makePieceCode(color, ROOK)) {
+            rights |= color == WHITE ? WHITE_KING_SIDE : BLACK_KING_SIDE;
+        }
+        if (state.mailbox[home] == makePieceCode(color, ROOK)) {
+            rights |= color == WHITE ? WHITE_QUEEN_SIDE : BLACK_QUEEN_SIDE;
         }
     }
-    this->whiteTurn = other.whiteTurn;
-    this->lastMove = other.lastMove;
+    return rights;
+}
 
+// Whether the side that just moved can have advanced a pawn two squares on file
+static bool isValidEnPassantFile(const BoardState& state, int file) {
+    if (file < 0 || file > 7) {
+        return false;
+    }
+    Color them = state.whiteTurn ? BLACK : WHITE;
+    int pawn = squareOf(file, them == WHITE ? 3 : 4);
+    int passed = squareOf(file, them == WHITE ? 2 : 5);
+    int origin = squareOf(file, them == WHITE ? 1 : 6);
+    return state.mailbox[pawn] == makePieceCode(them, PAWN)
+        && state.mailbox[passed] == NO_PIECE && state.mailbox[origin] == NO_PIECE;
+}
+
+// The part of the key that isn't a piece on a square or the side to move
+static uint64_t rightsKey(const BoardState& state) {
+    return zobrist.castling[state.castling]
+         ^ (state.epFile != NO_EN_PASSANT ? zobrist.enPassant[state.epFile] : 0);
+}
+
+Board::Board() : ply(0), statusKey(0), cachedStatus(GameStatus::Normal), statusCached(false) {
+    state.clear();
+    state.key = computeHash();
+}
+
+Board::Board(const Board& other)
+    : state(other.state), ply(other.ply), statusKey(other.statusKey), cachedStatus(other.cachedStatus), statusCached(other.statusCached) {
+    std::copy(other.undoStack, other.undoStack + other.ply, undoStack);
 }
 
 Board& Board::operator=(const Board& other) {
     if (this == &other) return *this; // Handle self-assignment
 
-    // Deep copy of the board
-    for (int y = 0; y < 8; ++y) {
-        for (int x = 0; x < 8; ++x) {
-            if (other.squares[y][x]) {
-                squares[y][x] = other.squares[y][x]->clone();
-            } else {
-                squares[y][x] = nullptr;
-            }
-        }
-    }
-
-    this->whiteTurn = other.whiteTurn;
-    this->lastMove = other.lastMove;
+    state = other.state;
+    ply = other.ply;
+    statusKey = other.statusKey;
+    cachedStatus = other.cachedStatus;
+    statusCached = other.statusCached;
+    std::copy(other.undoStack, other.undoStack + other.ply, undoStack);
     return *this;
 }
 
-std::shared_ptr<Piece> Board::at(const Position& pos) const {
-    return squares[pos.y][pos.x];
+Piece Board::at(const Position& pos) const {
+    return Piece(state.mailbox[squareOf(pos)]);
+}
+
+Piece Board::at(const int x, const int y) const {
+    return Piece(state.mailbox[squareOf(x, y)]);
+}
+
+const BoardState& Board::getState() const {
+    return state;
+}
+
+int Board::getCastlingRights() const {
+    return state.castling;
+}
+
+void Board::setCastlingRights(int rights) {
+    state.key ^= rightsKey(state);
+    state.castling = uint8_t(rights & possibleCastlingRights(state));
+    state.key ^= rightsKey(state);
+}
+
+int Board::getEnPassantFile() const {
+    return state.epFile;
+}
+
+bool Board::setEnPassantFile(int file) {
+    bool valid = isValidEnPassantFile(state, file);
+    state.key ^= rightsKey(state);
+    state.epFile = valid ? uint8_t(file) : NO_EN_PASSANT;
+    state.key ^= rightsKey(state);
+    return valid;
 }
 
-std::shared_ptr<Piece> Board::at(const int x, const int y) const {
-    return squares[y][x];
+uint64_t Board::hash() const {
+    return state.key;
+}
+
+uint64_t Board::computeHash() const {
+    uint64_t key = rightsKey(state);
+    for (int square = 0; square < 64; ++square) {
+        if (state.mailbox[square] != NO_PIECE) {
+            key ^= zobrist.piece[state.mailbox[square]][square];
+        }
+    }
+    if (!state.whiteTurn) {
+        key ^= zobrist.side;
+    }
+    return key;
 }
 
 void Board::setupBoard() {
-    // Placing white pieces
-    squares[0][0] = std::make_shared<Rook>(true);
-    squares[0][1] = std::make_shared<Knight>(true);
-    squares[0][2] = std::make_shared<Bishop>(true);
-    squares[0][3] = std::make_shared<Queen>(true);
-    squares[0][4] = std::make_shared<King>(true);
-    squares[0][5] = std::make_shared<Bishop>(true);
-    squares[0][6] = std::make_shared<Knight>(true);
-    squares[0][7] = std::make_shared<Rook>(true);
-
-    // Placing black pieces
-    squares[7][0] = std::make_shared<Rook>(false);
-    squares[7][1] = std::make_shared<Knight>(false);
-    squares[7][2] = std::make_shared<Bishop>(false);
-    squares[7][3] = std::make_shared<Queen>(false);
-    squares[7][4] = std::make_shared<King>(false);
-    squares[7][5] = std::make_shared<Bishop>(false);
-    squares[7][6] = std::make_shared<Knight>(false);
-    squares[7][7] = std::make_shared<Rook>(false);
-
-    // Placing pawns
-    for (int i = 0; i < 8; i++) {
-        squares[1][i] = std::make_shared<Pawn>(true);
-        squares[6][i] = std::make_shared<Pawn>(false);
+    static const PieceType backRank[8] = {ROOK, KNIGHT, BISHOP, QUEEN, KING, BISHOP, KNIGHT, ROOK};
+
+    bool whiteTurn = state.whiteTurn;
+    state.clear();
+    state.whiteTurn = whiteTurn;
+
+    for (int x = 0; x < 8; x++) {
+        // Placing white and black pieces
+        state.put(squareOf(x, 0), makePieceCode(WHITE, backRank[x]));
+        state.put(squareOf(x, 7), makePieceCode(BLACK, backRank[x]));
+
+        // Placing pawns
+        state.put(squareOf(x, 1), makePieceCode(WHITE, PAWN));
+        state.put(squareOf(x, 6), makePieceCode(BLACK, PAWN));
     }
+    state.key = computeHash();
 }
 
 void Board::clearBoard() {
-    for (auto &row : squares) {
-        std::fill(row.begin(), row.end(), nullptr);
+    for (int square = 0; square < 64; ++square) {
+        state.remove(square);
     }
+    state.key = computeHash();
+}
+
+// Loads a position in Forsyth-Edwards Notation. The move counters are
+// ignored, as are castling rights and en passant squares the placement rules
+// out.
+bool Board::setFen(const std::string& fen) {
+    static const std::string symbols = "pnbrqk";
+    std::istringstream stream(fen);
+    std::string placement, side, castling = "-", enPassant = "-";
+    if (!(stream >> placement >> side)) {
+        return false;
+    }
+    stream >> castling >> enPassant;
+
+    BoardState next;
+    next.clear();
+    next.castling = NO_CASTLING;
+
+    int x = 0, y = 7;
+    for (char c : placement) {
+        if (c == '/') {
+            if (x != 8 || --y < 0) return false;
+            x = 0;
+        } else if (c >= '1' && c <= '8') {
+            x += c - '0';
+            if (x > 8) return false;
+        } else {
+            size_t type = symbols.find(std::tolower(c));
+            if (type == std::string::npos || x > 7) return false;
+            Color color = std::isupper(c) ? WHITE : BLACK;
+            next.put(squareOf(x, y), makePieceCode(color, PieceType(type)));
+            x++;
+        }
+    }
+    if (x != 8 || y != 0 || (side != "w" && side != "b")) {
+        return false;
+    }
+    next.whiteTurn = side == "w";
+
+    for (char c : castling) {
+        switch (c) {
+            case 'K': next.castling |= WHITE_KING_SIDE; break;
+            case 'Q': next.castling |= WHITE_QUEEN_SIDE; break;
+            case 'k': next.castling |= BLACK_KING_SIDE; break;
+            case 'q': next.castling |= BLACK_QUEEN_SIDE; break;
+            case '-': break;
+            default: return false;
+        }
+    }
+
+    if (enPassant != "-") {
+        if (enPassant.size() != 2 || enPassant[0] < 'a' || enPassant[0] > 'h'
+            || (enPassant[1] != '3' && enPassant[1] != '6')) {
+            return false;
+        }
+        int file = enPassant[0] - 'a';
+        if (isValidEnPassantFile(next, file)) {
+            next.epFile = uint8_t(file);
+        }
+    }
+    next.castling &= possibleCastlingRights(next);
+
+    state = next;
+    state.key = computeHash();
+    ply = 0;
+    return true;
 }
 
 void Board::printBoard() const {
@@ -97,8 +244,9 @@ void Board::printBoard() const {
     for (int y = 7; y >= 0; --y) {
         std::cout << y + 1 << " ";
         for (int x = 0; x < 8; ++x) {
-            if (squares[y][x]) {
-                char symbol = squares[y][x]->getSymbol();
+            Piece piece = at(x, y);
+            if (piece) {
+                char symbol = piece.getSymbol();
                 auto it = unicodeSymbols.find(symbol);
                 if (it != unicodeSymbols.end()) {
                     std::cout << it->second << " "; // Print Unicode symbol
@@ -116,153 +264,290 @@ void Board::printBoard() const {
 
 
 bool Board::isWhiteTurn() const {
-    return whiteTurn;
+    return state.whiteTurn;
 }
 
 void Board::setWhiteTurn(bool whiteTurn) {
-    this->whiteTurn = whiteTurn;
+    if (state.whiteTurn != whiteTurn) {
+        // An en passant chance belongs to the side that was to move
+        setEnPassantFile(NO_EN_PASSANT);
+        state.key ^= zobrist.side;
+    }
+    state.whiteTurn = whiteTurn;
 }
 
-void Board::setPiece(const Position& pos, std::shared_ptr<Piece> piece) {
-    squares[pos.y][pos.x] = piece;
+void Board::setPiece(const Position& pos, Piece piece) {
+    int square = squareOf(pos);
+    state.remove(square);
+    if (piece) {
+        state.put(square, piece.getCode());
+    }
 }
 
-std::shared_ptr<Piece> Board::removePiece(const Position& pos) {
-    auto piece = squares[pos.y][pos.x];
-    squares[pos.y][pos.x] = nullptr;
-    return piece;
+Piece Board::removePiece(const Position& pos) {
+    return Piece(state.remove(squareOf(pos)));
 }
 
 bool Board::movePiece(const Position& start, const Position& end) {
     auto piece = at(start);
-    if (!piece || !piece->isValidMove(start, end, *this)) {
+    if (!piece) {
         return false;
     }
 
-    Board testBoard(*this);
-    testBoard.at(start).get()->move(start, end, testBoard);
-    if (testBoard.isCheck(piece->getIsWhite())) {
+    MoveList moves;
+    generateLegalMoves(state, piece.getIsWhite() ? WHITE : BLACK, moves);
+    for (const Move& move : moves) {
+        if (move.from() == squareOf(start) && move.to() == squareOf(end)) {
+            // Promotion is left to the caller; the pawn stays a pawn here
+            commitMove(move.isPromotion() ? Move(move.from(), move.to()) : move);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Board::movePiece(const Move& move) {
+    uint8_t piece = state.mailbox[move.from()];
+    if (piece == NO_PIECE) {
         return false;
     }
 
-    piece->move(start, end, *this);
-    lastMove = {start, end};
+    MoveList moves;
+    generateLegalMoves(state, pieceCodeColor(piece), moves);
+    if (std::find(moves.begin(), moves.end(), move) == moves.end()) {
+        return false;
+    }
+    commitMove(move);
     return true;
 }
 
-bool Board::isCheck(bool isWhite) const {
-    Position kingPos;
-    bool kingFound = false;
+// Game moves are never taken back, so don't let them fill the undo stack
+void Board::commitMove(const Move& move) {
+    makeMove(move);
+    --ply;
+}
 
-    // Find the king's position
-    for (int y = 0; y < 8; ++y) {
-        for (int x = 0; x < 8; ++x) {
-            auto piece = at(x, y);
-            if (piece && piece->getSymbol() == (isWhite ? 'K' : 'k')) {
-                kingPos = Position(x, y);
-                kingFound = true;
-                break;
-            }
+void Board::makeMove(const Move& move) {
+    UndoEntry& undo = undoStack[ply++];
+    int from = move.from();
+    int to = move.to();
+    undo.move = move;
+    undo.castling = state.castling;
+    undo.epFile = state.epFile;
+    undo.key = state.key;
+    state.key ^= rightsKey(state);
+
+    uint8_t piece = state.remove(from);
+
+    // En passant captures the pawn beside the origin square, not on the target
+    int capturedSquare = move.flag() == EN_PASSANT ? squareOf(to & 7, from >> 3) : to;
+    undo.moved = piece;
+    undo.captured = state.remove(capturedSquare);
+    undo.capturedSquare = capturedSquare;
+
+    if (move.flag() == CASTLING) {
+        // Castling also moves the rook next to the king
+        int rookFrom = to > from ? to + 1 : to - 2;
+        int rookTo = to > from ? to - 1 : to + 1;
+        state.put(rookTo, state.remove(rookFrom));
+    } else if (move.flag() == PROMOTION) {
+        piece = makePieceCode(pieceCodeColor(piece), move.promotion());
+    }
+    state.put(to, piece);
+
+    state.castling &= castlingMask(from) & castlingMask(to);
+    state.epFile = pieceCodeType(piece) == PAWN && std::abs(to - from) == 16 ? uint8_t(to & 7) : NO_EN_PASSANT;
+    state.whiteTurn = !state.whiteTurn;
+    state.key ^= rightsKey(state) ^ zobrist.side;
+
+#ifdef HASH_DEBUG
+    assert(state.key == computeHash());
+#endif
+}
+
+void Board::unmakeMove() {
+    const UndoEntry& undo = undoStack[--ply];
+    int from = undo.move.from();
+    int to = undo.move.to();
+
+    state.remove(to);
+    state.put(from, undo.moved);
+    if (undo.captured != NO_PIECE) {
+        state.put(undo.capturedSquare, undo.captured);
+    }
+
+    if (undo.move.flag() == CASTLING) {
+        int rookFrom = to > from ? to + 1 : to - 2;
+        int rookTo = to > from ? to - 1 : to + 1;
+        state.put(rookFrom, state.remove(rookTo));
+    }
+
+    state.castling = undo.castling;
+    state.epFile = undo.epFile;
+    state.whiteTurn = !state.whiteTurn;
+    state.key = undo.key;
+
+#ifdef HASH_DEBUG
+    assert(state.key == computeHash());
+#endif
+}
+
+void Board::makeNullMove() {
+    UndoEntry& undo = undoStack[ply++];
+    undo.move = Move(0, 0);
+    undo.captured = NO_PIECE;
+    undo.castling = state.castling;
+    undo.epFile = state.epFile;
+    undo.key = state.key;
+
+    state.key ^= rightsKey(state);
+    state.epFile = NO_EN_PASSANT;
+    state.whiteTurn = !state.whiteTurn;
+    state.key ^= rightsKey(state) ^ zobrist.side;
+}
+
+void Board::unmakeNullMove() {
+    const UndoEntry& undo = undoStack[--ply];
+    state.epFile = undo.epFile;
+    state.whiteTurn = !state.whiteTurn;
+    state.key = undo.key;
+}
+
+bool Board::isRepetition() const {
+    // Only positions with the same side to move can match, and none from
+    // before a null move, which no real game reaches
+    for (int i = ply - 1; i >= 0 && undoStack[i].move != Move(0, 0); --i) {
+        if ((ply - i) % 2 == 0 && undoStack[i].key == state.key) {
+            return true;
         }
-        if (kingFound) break;
+    }
+    return false;
+}
+
+bool Board::isCheck(bool isWhite) const {
+    Bitboard king = state.pieces[isWhite ? WHITE : BLACK][KING];
+    if (!king) {
+        return false;
     }
 
     // Check if any opponent's piece can attack the king
-    return canBeCaptured(kingPos, isWhite);
+    return canBeCaptured(positionOf(lsb(king)), isWhite);
+}
+
+GameStatus Board::status() const {
+    if (statusCached && statusKey == state.key) {
+        return cachedStatus;
+    }
+
+    MoveList moves;
+    generateLegalMoves(state, state.whiteTurn ? WHITE : BLACK, moves);
+    bool check = isCheck(state.whiteTurn);
+    if (moves.empty()) {
+        cachedStatus = check ? GameStatus::Checkmate : GameStatus::Stalemate;
+    } else {
+        cachedStatus = check ? GameStatus::Check : GameStatus::Normal;
+    }
+    statusKey = state.key;
+    statusCached = true;
+    return cachedStatus;
 }
 
 bool Board::isCheckmate(bool isWhite) const {
+    if (isWhite == state.whiteTurn) {
+        return status() == GameStatus::Checkmate;
+    }
     if (!isCheck(isWhite)) {
         return false;
     }
 
     // Check if there is any valid move to get out of check
-    for (int y = 0; y < 8; ++y) {
-        for (int x = 0; x < 8; ++x) {
-            Position start(x, y);
-            auto piece = at(start);
-            if (piece && piece->getIsWhite() == isWhite) {
-                auto validMoves = piece->getValidMoves(start, *this);
-                for (const auto& end : validMoves) {
-                    Board testBoard(*this);
-                    testBoard.movePiece(start, end);
-                    if (!testBoard.isCheck(isWhite)) {
-                        return false;
-                    }
-                }
-            }
-        }
-    }
-    return true;
+    MoveList moves;
+    generateLegalMoves(state, isWhite ? WHITE : BLACK, moves);
+    return moves.empty();
 }
 
 bool Board::isStalemate(bool isWhite) const {
+    if (isWhite == state.whiteTurn) {
+        return status() == GameStatus::Stalemate;
+    }
     if (isCheck(isWhite)) {
         return false;
     }
 
     // Check if there are any valid moves available
-    for (int y = 0; y < 8; ++y) {
-        for (int x = 0; x < 8; ++x) {
-            Position start(x, y);
-            auto piece = at(start);
-            if (piece && piece->getIsWhite() == isWhite) {
-                auto validMoves = piece->getValidMoves(start, *this);
-                for (const auto& end : validMoves) {
-                    Board testBoard(*this);
-                    testBoard.movePiece(start, end);
-                    if (!testBoard.isCheck(isWhite)) {
-                        return false;
-                    }
-                }
-            }
-        }
-    }
-    return true;
+    MoveList moves;
+    generateLegalMoves(state, isWhite ? WHITE : BLACK, moves);
+    return moves.empty();
 }
 
 bool Board::canBeCaptured(const Position& position, const bool isWhite) const {
-    for (int x = 0; x < 8; ++x) {
-        for (int y = 0; y < 8; ++y) {
-            auto piece = at(x, y);
-            if (piece && piece->getIsWhite() != isWhite) {
-                Position start(x, y);
-                if (piece->isValidMove(start, position, *this)) {
-                    return true;
-                }
-            }
-        }
-    }
-    return false;
+    Bitboard enemies = state.byColor[isWhite ? BLACK : WHITE];
+    return attackersTo(state, squareOf(position), state.occupied()) & enemies;
 }
 
-std::vector<playerAction> Board::getPossibleActions(bool isWhite) const {
-    std::vector<playerAction> actions;
+// Swap algorithm: both sides recapture on the destination with their least
+// valuable attacker, and gain[d] is what the side making capture d has won
+// if the sequence stopped there. Sliders behind a piece that just captured
+// join in through the occupancy it leaves. Pins are ignored.
+int Board::see(const Move& move) const {
+    if (move.flag() == CASTLING) {
+        return 0;
+    }
 
-    for (int y = 0; y < 8; ++y) {
-        for (int x = 0; x < 8; ++x) {
-            Position start(x, y);
-            auto piece = at(start);
-            if (piece && piece->getIsWhite() == isWhite) {
-                auto validMoves = piece->getValidMoves(start, *this);
-                for (const auto& end : validMoves) {
-                    Board testBoard(*this);
-                    auto capturedPiece = testBoard.at(end);
-                    bool isCapture = capturedPiece != nullptr;
-                    testBoard.movePiece(start, end);
-                    bool canBeCaptured = testBoard.canBeCaptured(end, isWhite);
-                    bool isCheck = testBoard.isCheck(isWhite);
-                    bool isCheckmate = testBoard.isCheckmate(!isWhite);
-
-                    actions.push_back(playerAction(start, end, piece.get(), capturedPiece.get(), isCapture, canBeCaptured, isCheck, isCheckmate));
-                }
-            }
-        }
+    int from = move.from();
+    int to = move.to();
+    Color side = Color(pieceCodeColor(state.mailbox[from]) ^ 1);
+    Bitboard occupied = state.occupied() ^ squareBB(from);
+    Bitboard bishops = state.pieces[WHITE][BISHOP] | state.pieces[BLACK][BISHOP] | state.pieces[WHITE][QUEEN] | state.pieces[BLACK][QUEEN];
+    Bitboard rooks = state.pieces[WHITE][ROOK] | state.pieces[BLACK][ROOK] | state.pieces[WHITE][QUEEN] | state.pieces[BLACK][QUEEN];
+
+    int gain[32];
+    int d = 0;
+    int onSquare = Piece(state.mailbox[from]).getValue();
+    if (move.flag() == EN_PASSANT) {
+        gain[0] = Piece(PAWN, true).getValue();
+        occupied ^= squareBB(to + (side == WHITE ? 8 : -8));
+    } else {
+        gain[0] = state.mailbox[to] != NO_PIECE ? Piece(state.mailbox[to]).getValue() : 0;
+    }
+    if (move.isPromotion()) {
+        onSquare = Piece(move.promotion(), true).getValue();
+        gain[0] += onSquare - Piece(PAWN, true).getValue();
     }
 
-    return actions;
-}
+    Bitboard attackers = attackersTo(state, to, occupied) & occupied;
+    while (d < 31) {
+        Bitboard ours = attackers & state.byColor[side];
+        if (!ours) {
+            break;
+        }
+        int type = PAWN;
+        while (!(ours & state.pieces[side][type])) {
+            ++type;
+        }
+        Bitboard attacker = ours & state.pieces[side][type];
+        // The king may only take last
+        if (type == KING && (attackers & state.byColor[side ^ 1])) {
+            break;
+        }
+
+        ++d;
+        gain[d] = onSquare - gain[d - 1];
+        onSquare = Piece(PieceType(type), true).getValue();
+        occupied ^= squareBB(lsb(attacker));
+        if (type == PAWN || type == BISHOP || type == QUEEN) {
+            attackers |= bishopAttacks(to, occupied) & bishops;
+        }
+        if (type == ROOK || type == QUEEN) {
+            attackers |= rookAttacks(to, occupied) & rooks;
+        }
+        attackers &= occupied;
+        side = Color(side ^ 1);
+    }
 
-std::pair<Position,Position> Board::getLastMove() const {
-    return lastMove;
+    // Either side may stop recapturing when going on would lose more
+    for (; d > 0; --d) {
+        gain[d - 1] = -std::max(-gain[d - 1], gain[d]);
+    }
+    return gain[0];
 }
@@ -18,10 +18,10 @@ void GraphicalDisplay::drawBoard(const Board &newBoard)
             bool isWhiteSquare = (x + y) % 2 == 0;
             window.fillRectangle(x * squareSize, (7 - y) * squareSize, squareSize, squareSize, isWhiteSquare ? SFMLWindow::White : SFMLWindow::Black);
 
-            auto newPiece = newBoard.at(Position(x, y));
+            Piece newPiece = newBoard.at(Position(x, y));
             if (newPiece)
             {
-                window.drawPeice(x * squareSize, (7 - y) * squareSize - 5, newPiece->getSymbol(), isWhiteSquare ? SFMLWindow::Black : SFMLWindow::White);
+                window.drawPeice(x * squareSize, (7 - y) * squareSize - 5, newPiece.getSymbol(), isWhiteSquare ? SFMLWindow::Black : SFMLWindow::White);
             }
         }
     }
@@ -38,7 +38,7 @@ void GraphicalDisplay::updateStatus(const std::string &status) {
     drawBoard(board);
 }
 
-void GraphicalDisplay::processEvents()
+SFMLWindow::Request GraphicalDisplay::processEvents()
 {
-    window.processEvents();
+    return window.processEvents();
 }
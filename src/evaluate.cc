@@ -0,0 +1,106 @@
+#include "evaluate.h"
+#include "board.h"
+
+static constexpr int mgMaterial[PIECE_TYPE_NB] = {100, 320, 330, 500, 900, 0};
+static constexpr int egMaterial[PIECE_TYPE_NB] = {120, 290, 310, 530, 950, 0};
+static constexpr int phaseWeight[PIECE_TYPE_NB] = {0, 1, 1, 2, 4, 0};
+
+// Bonuses for a white piece, written as seen from white with rank 8 on top.
+// Pawns and the king play differently in the endgame and have a table of
+// their own for it; the other pieces use one table for both phases.
+static constexpr int mgTables[PIECE_TYPE_NB][64] = {
+    {   0,   0,   0,   0,   0,   0,   0,   0,
+       50,  50,  50,  50,  50,  50,  50,  50,
+       10,  10,  20,  30,  30,  20,  10,  10,
+        5,   5,  10,  25,  25,  10,   5,   5,
+        0,   0,   0,  20,  20,   0,   0,   0,
+        5,  -5, -10,   0,   0, -10,  -5,   5,
+        5,  10,  10, -20, -20,  10,  10,   5,
+        0,   0,   0,   0,   0,   0,   0,   0 },
+    { -50, -40, -30, -30, -30, -30, -40, -50,
+      -40, -20,   0,   0,   0,   0, -20, -40,
+      -30,   0,  10,  15,  15,  10,   0, -30,
+      -30,   5,  15,  20,  20,  15,   5, -30,
+      -30,   0,  15,  20,  20,  15,   0, -30,
+      -30,   5,  10,  15,  15,  10,   5, -30,
+      -40, -20,   0,   5,   5,   0, -20, -40,
+      -50, -40, -30, -30, -30, -30, -40, -50 },
+    { -20, -10, -10, -10, -10, -10, -10, -20,
+      -10,   0,   0,   0,   0,   0,   0, -10,
+      -10,   0,   5,  10,  10,   5,   0, -10,
+      -10,   5,   5,  10,  10,   5,   5, -10,
+      -10,   0,  10,  10,  10,  10,   0, -10,
+      -10,  10,  10,  10,  10,  10,  10, -10,
+      -10,   5,   0,   0,   0,   0,   5, -10,
+      -20, -10, -10, -10, -10, -10, -10, -20 },
+    {   0,   0,   0,   0,   0,   0,   0,   0,
+        5,  10,  10,  10,  10,  10,  10,   5,
+       -5,   0,   0,   0,   0,   0,   0,  -5,
+       -5,   0,   0,   0,   0,   0,   0,  -5,
+       -5,   0,   0,   0,   0,   0,   0,  -5,
+       -5,   0,   0,   0,   0,   0,   0,  -5,
+       -5,   0,   0,   0,   0,   0,   0,  -5,
+        0,   0,   0,   5,   5,   0,   0,   0 },
+    { -20, -10, -10,  -5,  -5, -10, -10, -20,
+      -10,   0,   0,   0,   0,   0,   0, -10,
+      -10,   0,   5,   5,   5,   5,   0, -10,
+       -5,   0,   5,   5,   5,   5,   0,  -5,
+        0,   0,   5,   5,   5,   5,   0,  -5,
+      -10,   5,   5,   5,   5,   5,   0, -10,
+      -10,   0,   5,   0,   0,   0,   0, -10,
+      -20, -10, -10,  -5,  -5, -10, -10, -20 },
+    { -30, -40, -40, -50, -50, -40, -40, -30,
+      -30, -40, -40, -50, -50, -40, -40, -30,
+      -30, -40, -40, -50, -50, -40, -40, -30,
+      -30, -40, -40, -50, -50, -40, -40, -30,
+      -20, -30, -30, -40, -40, -30, -30, -20,
+      -10, -20, -20, -20, -20, -20, -20, -10,
+       20,  20,   0,   0,   0,   0,  20,  20,
+       20,  30,  10,   0,   0,  10,  30,  20 },
+};
+
+static constexpr int egPawnTable[64] = {
+      0,   0,   0,   0,   0,   0,   0,   0,
+     90,  90,  90,  90,  90,  90,  90,  90,
+     55,  55,  55,  55,  55,  55,  55,  55,
+     30,  30,  30,  30,  30,  30,  30,  30,
+     15,  15,  15,  15,  15,  15,  15,  15,
+      5,   5,   5,   5,   5,   5,   5,   5,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0 };
+
+static constexpr int egKingTable[64] = {
+    -50, -40, -30, -20, -20, -30, -40, -50,
+    -30, -20, -10,   0,   0, -10, -20, -30,
+    -30, -10,  20,  30,  30,  20, -10, -30,
+    -30, -10,  30,  40,  40,  30, -10, -30,
+    -30, -10,  30,  40,  40,  30, -10, -30,
+    -30, -10,  20,  30,  30,  20, -10, -30,
+    -30, -30,   0,   0,   0,   0, -30, -30,
+    -50, -30, -30, -30, -30, -30, -30, -50 };
+
+constexpr PieceSquareTables::PieceSquareTables() : mg(), eg(), phase() {
+    for (int color = WHITE; color <= BLACK; ++color) {
+        for (int type = PAWN; type < PIECE_TYPE_NB; ++type) {
+            int code = (color << 3) | (type + 1);
+            int sign = color == WHITE ? 1 : -1;
+            phase[code] = int8_t(phaseWeight[type]);
+            for (int square = 0; square < 64; ++square) {
+                // The tables list rank 8 first; black reads them mirrored
+                int index = color == WHITE ? square ^ 56 : square;
+                int egBonus = type == PAWN ? egPawnTable[index] : type == KING ? egKingTable[index] : mgTables[type][index];
+                mg[code][square] = int16_t(sign * (mgMaterial[type] + mgTables[type][index]));
+                eg[code][square] = int16_t(sign * (egMaterial[type] + egBonus));
+            }
+        }
+    }
+}
+
+constexpr PieceSquareTables psq;
+
+int evaluate(const Board& board) {
+    const BoardState& state = board.getState();
+    int phase = state.phase < MAX_PHASE ? state.phase : MAX_PHASE;
+    int score = (state.mgScore * phase + state.egScore * (MAX_PHASE - phase)) / MAX_PHASE;
+    return state.whiteTurn ? score : -score;
+}
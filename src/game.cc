@@ -7,30 +7,47 @@ Game::Game(Board board, std::unique_ptr<Player>&& whitePlayer, std::unique_ptr<P
 
 void Game::runGame() {
     display.updateStatus("New game started!");
+
+    // Computer players search on their own thread and call back here, so the
+    // window keeps handling events while they think
+    auto pumpEvents = [this]() {
+        switch (display.processEvents()) {
+            case SFMLWindow::MoveNow:
+                return SearchInterrupt::MoveNow;
+            case SFMLWindow::AbortSearch:
+                return SearchInterrupt::Abort;
+            default:
+                return SearchInterrupt::None;
+        }
+    };
+    whitePlayer->setIdleHandler(pumpEvents);
+    blackPlayer->setIdleHandler(pumpEvents);
     while (!isGameOver()) {
         display.processEvents(); // Ensure the window processes events
         board.printBoard();
         display.drawBoard(board);
         display.processEvents(); // Keep processing events during the game
 
-        if (board.isWhiteTurn()) {
-            if (!whitePlayer->makeAction(board)) {
-                std::cout << "Black wins!" << std::endl;
-                display.updateStatus("Black wins!");
-                outcome = GameOutcome::BlackWins;
-                break;
-            }
-        } else {
-            if (!blackPlayer->makeAction(board)) {
-                std::cout << "White wins!" << std::endl;
-                display.updateStatus("White wins!");
-                outcome = GameOutcome::WhiteWins;
-                break;
-            }
+        // While a person thinks, the other player may ponder
+        bool whiteToMove = board.isWhiteTurn();
+        Player& mover = whiteToMove ? *whitePlayer : *blackPlayer;
+        Player& waiting = whiteToMove ? *blackPlayer : *whitePlayer;
+        if (mover.isHuman()) {
+            waiting.ponder(board);
+        }
+        bool moved = mover.makeAction(board);
+        if (mover.isHuman()) {
+            waiting.stopPondering(board);
+        }
+
+        if (!moved) {
+            std::cout << (whiteToMove ? "Black wins!" : "White wins!") << std::endl;
+            display.updateStatus(whiteToMove ? "Black wins!" : "White wins!");
+            outcome = whiteToMove ? GameOutcome::BlackWins : GameOutcome::WhiteWins;
+            break;
         }
 
         display.updateStatus(" ");
-        switchTurn();
     }
     display.processEvents(); // Final event processing before the game ends
 }
@@ -39,42 +56,28 @@ GameOutcome Game::getOutcome() const {
     return outcome;
 }
 
-void Game::switchTurn() {
-    board.setWhiteTurn(!board.isWhiteTurn());
-}
-
 bool Game::isGameOver() {
-    // Check if the game is over
-    if (board.isStalemate(true) || board.isCheckmate(true)) {
-        std::cout << "Stalemate!" << std::endl;
-        display.updateStatus("Stalemate!");
-        outcome = GameOutcome::Stalemate;
-        return true;
-    }
-
-    if (board.isCheckmate(true)) {
-        std::cout << "Checkmate! Black wins!" << std::endl;
-        display.updateStatus("Checkmate! Black wins!");
-        outcome = GameOutcome::BlackWins;
-        return true;
-    }
+    // One legal move generation answers every question about the side to move
+    bool whiteToMove = board.isWhiteTurn();
+    switch (board.status()) {
+        case GameStatus::Stalemate:
+            std::cout << "Stalemate!" << std::endl;
+            display.updateStatus("Stalemate!");
+            outcome = GameOutcome::Stalemate;
+            return true;
 
-    if (board.isCheckmate(false)) {
-        std::cout << "Checkmate! White wins!" << std::endl;
-        display.updateStatus("Checkmate! White wins!");
-        outcome = GameOutcome::WhiteWins;
-        return true;
-    }
+        case GameStatus::Checkmate:
+            std::cout << (whiteToMove ? "Checkmate! Black wins!" : "Checkmate! White wins!") << std::endl;
+            display.updateStatus(whiteToMove ? "Checkmate! Black wins!" : "Checkmate! White wins!");
+            outcome = whiteToMove ? GameOutcome::BlackWins : GameOutcome::WhiteWins;
+            return true;
 
-    if (board.isCheck(true)) {
-        std::cout << "White is in check!" << std::endl;
-        display.updateStatus("White is in check!");
-    }
+        case GameStatus::Check:
+            std::cout << (whiteToMove ? "White is in check!" : "Black is in check!") << std::endl;
+            display.updateStatus(whiteToMove ? "White is in check!" : "Black is in check!");
+            return false;
 
-    if (board.isCheck(false)) {
-        std::cout << "Black is in check!" << std::endl;
-        display.updateStatus("Black is in check!");
+        default:
+            return false;
     }
-
-    return false;
 }
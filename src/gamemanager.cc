@@ -3,6 +3,9 @@
 #include <sstream>
 #include <memory>
 #include "gamemanager.h"
+#include "book.h"
+#include "nnue.h"
+#include "tablebase.h"
 
 GameManager::GameManager() : hasSetup(false), whiteScore(0), blackScore(0) {}
 
@@ -35,6 +38,58 @@ void GameManager::processCommand(const std::string& command) {
         setupManager.enterSetupMode();
         board = setupManager.getBoard();
         hasSetup = true;
+    } else if (cmd == "book") {
+        // book <file.bin> [moves per side] [best|weighted], or book off
+        std::string bookPath, option;
+        iss >> bookPath;
+        if (bookPath == "off") {
+            openingBook.close();
+            std::cout << "Opening book closed." << std::endl;
+            return;
+        }
+        if (!openingBook.open(bookPath)) {
+            std::cout << "Could not open book " << bookPath << std::endl;
+            return;
+        }
+        openingBook.setSelection(OpeningBook::WEIGHTED);
+        while (iss >> option) {
+            if (option == "best") {
+                openingBook.setSelection(OpeningBook::BEST);
+            } else if (option == "weighted") {
+                openingBook.setSelection(OpeningBook::WEIGHTED);
+            } else if (std::all_of(option.begin(), option.end(), ::isdigit)) {
+                openingBook.setMaxMoves(std::stoi(option.substr(0, 4)));
+            }
+        }
+        std::cout << "Opening book " << bookPath << " open, used for the first "
+                  << openingBook.getMaxMoves() << " moves of each computer player." << std::endl;
+    } else if (cmd == "nnue") {
+        // Searching levels evaluate with the network from their next move on
+        std::string path;
+        iss >> path;
+        if (path == "off") {
+            network.unload();
+            std::cout << "Using the built-in evaluation." << std::endl;
+        } else if (!path.empty() && network.load(path)) {
+            std::cout << "Loaded network " << path << " (" << Network::kernelName() << " kernels)." << std::endl;
+        } else {
+            std::cout << "Could not load network file: " << path << std::endl;
+        }
+    } else if (cmd == "tb") {
+        // tb <directory> maps every table file in it, tb off unmaps them
+        std::string directory;
+        if (!(iss >> directory)) {
+            directory = ".";
+        }
+        if (directory == "off") {
+            tablebases.clear();
+            std::cout << "Endgame tables closed." << std::endl;
+        } else if (int count = tablebases.load(directory)) {
+            std::cout << "Loaded " << count << " endgame tables, up to "
+                      << tablebases.maxPieces() << " pieces." << std::endl;
+        } else {
+            std::cout << "No endgame tables in " << directory << std::endl;
+        }
     } else {
         std::cout << "Unknown command: " << command << std::endl;
     }
@@ -45,6 +100,26 @@ std::unique_ptr<Player> GameManager::createPlayer(const std::string& playerType,
         return std::make_unique<HumanPlayer>(isWhite);
     } else if (playerType.rfind("computer", 0) == 0) {
         std::string levelStr = playerType.substr(8); // Extract the level part of the string
+        // An optional thread count follows the level, e.g. computer[6:4], and
+        // then an optional hash size in megabytes, e.g. computer[6:4:64]
+        std::string threadStr;
+        std::string hashStr;
+        size_t colon = levelStr.find(':');
+        if (colon != std::string::npos) {
+            threadStr = levelStr.substr(colon + 1);
+            levelStr.erase(colon);
+            size_t hashColon = threadStr.find(':');
+            if (hashColon != std::string::npos) {
+                hashStr = threadStr.substr(hashColon + 1);
+                threadStr.erase(hashColon);
+                hashStr.erase(std::remove_if(hashStr.begin(), hashStr.end(), [](char c) { return !std::isdigit(c); }), hashStr.end());
+            }
+            threadStr.erase(std::remove_if(threadStr.begin(), threadStr.end(), [](char c) { return !std::isdigit(c); }), threadStr.end());
+            if (threadStr.empty() || (hashColon != std::string::npos && hashStr.empty())) {
+                std::cout << "Invalid thread count format. Expected 'computer[6:4]' or 'computer[6:4:64]', etc." << std::endl;
+                return nullptr;
+            }
+        }
         levelStr.erase(std::remove_if(levelStr.begin(), levelStr.end(), [](char c) { return !std::isdigit(c); }), levelStr.end());
         
         if (levelStr.empty()) {
@@ -63,11 +138,28 @@ std::unique_ptr<Player> GameManager::createPlayer(const std::string& playerType,
             return nullptr;
         }
 
-        if (level < 1 || level > 4) {
-            std::cout << "Invalid computer level. Must be between 1 and 4." << std::endl;
+        if (level < 1 || level > 8) {
+            std::cout << "Invalid computer level. Must be between 1 and 8." << std::endl;
             return nullptr;
         }
-        return std::make_unique<ComputerPlayer>(isWhite, level);
+
+        int threads = 1;
+        if (!threadStr.empty()) {
+            threads = threadStr.size() <= 3 ? std::stoi(threadStr) : 0;
+            if (threads < 1 || threads > 256) {
+                std::cout << "Invalid thread count. Must be between 1 and 256." << std::endl;
+                return nullptr;
+            }
+        }
+        int hashMB = ComputerPlayer::DEFAULT_HASH_MB;
+        if (!hashStr.empty()) {
+            hashMB = hashStr.size() <= 4 ? std::stoi(hashStr) : 0;
+            if (hashMB < 1 || hashMB > 4096) {
+                std::cout << "Invalid hash size. Must be between 1 and 4096 megabytes." << std::endl;
+                return nullptr;
+            }
+        }
+        return std::make_unique<ComputerPlayer>(isWhite, level, threads, hashMB);
     } else {
         std::cout << "Invalid player type: " << playerType << std::endl;
         return nullptr;
@@ -0,0 +1,181 @@
+#include "movegen.h"
+#include "attacks.h"
+#include <cstdlib>
+
+Bitboard attackersTo(const BoardState& state, int square, Bitboard occupied) {
+    Bitboard queens = state.pieces[WHITE][QUEEN] | state.pieces[BLACK][QUEEN];
+    Bitboard rooks = state.pieces[WHITE][ROOK] | state.pieces[BLACK][ROOK] | queens;
+    Bitboard bishops = state.pieces[WHITE][BISHOP] | state.pieces[BLACK][BISHOP] | queens;
+
+    return (pawnAttacks(BLACK, square) & state.pieces[WHITE][PAWN])
+         | (pawnAttacks(WHITE, square) & state.pieces[BLACK][PAWN])
+         | (knightAttacks(square) & (state.pieces[WHITE][KNIGHT] | state.pieces[BLACK][KNIGHT]))
+         | (kingAttacks(square) & (state.pieces[WHITE][KING] | state.pieces[BLACK][KING]))
+         | (rookAttacks(square, occupied) & rooks)
+         | (bishopAttacks(square, occupied) & bishops);
+}
+
+static void pushPawnMove(MoveList& list, int from, int to) {
+    int rank = to >> 3;
+    if (rank == 0 || rank == 7) {
+        list.push(Move(from, to, QUEEN));
+        list.push(Move(from, to, ROOK));
+        list.push(Move(from, to, BISHOP));
+        list.push(Move(from, to, KNIGHT));
+    } else {
+        list.push(Move(from, to));
+    }
+}
+
+// Square a pawn of side us may capture en passant onto, or -1
+static int enPassantSquare(const BoardState& state, Color us) {
+    if (state.epFile == NO_EN_PASSANT) {
+        return -1;
+    }
+    return squareOf(state.epFile, us == WHITE ? 5 : 2);
+}
+
+static void generateCastling(const BoardState& state, Color us, int king, Bitboard occupied, MoveList& list) {
+    Bitboard theirs = state.byColor[us ^ 1];
+    Bitboard kingless = occupied ^ squareBB(king);
+    int kingSide = us == WHITE ? WHITE_KING_SIDE : BLACK_KING_SIDE;
+    int queenSide = us == WHITE ? WHITE_QUEEN_SIDE : BLACK_QUEEN_SIDE;
+    if (!(state.castling & (kingSide | queenSide)) || king != (us == WHITE ? 4 : 60)) return;
+
+    // King side: the rook on the h-file jumps to f, the king lands on g
+    if ((state.castling & kingSide) && state.mailbox[king + 3] == makePieceCode(us, ROOK)
+        && !(occupied & (squareBB(king + 1) | squareBB(king + 2)))
+        && !(attackersTo(state, king + 1, kingless) & theirs)
+        && !(attackersTo(state, king + 2, kingless) & theirs)) {
+        list.push(Move(king, king + 2, CASTLING));
+    }
+
+    // Queen side: the b, c and d squares must be empty
+    if ((state.castling & queenSide) && state.mailbox[king - 4] == makePieceCode(us, ROOK)
+        && !(occupied & (squareBB(king - 1) | squareBB(king - 2) | squareBB(king - 3)))
+        && !(attackersTo(state, king - 1, kingless) & theirs)
+        && !(attackersTo(state, king - 2, kingless) & theirs)) {
+        list.push(Move(king, king - 2, CASTLING));
+    }
+}
+
+void generateLegalMoves(const BoardState& state, Color us, MoveList& list, GenType type) {
+    Color them = Color(us ^ 1);
+    Bitboard ours = state.byColor[us];
+    Bitboard theirs = state.byColor[them];
+    Bitboard occupied = ours | theirs;
+    Bitboard kingBB = state.pieces[us][KING];
+
+    // Squares a non-pawn move of the requested kind may land on
+    Bitboard kindMask = type == CAPTURES ? theirs : type == QUIETS ? ~occupied : ~ours;
+
+    Bitboard checkMask = ~Bitboard(0);
+    Bitboard pinned = 0;
+    Bitboard pinMask[64];
+    int king = -1;
+
+    if (kingBB) {
+        king = lsb(kingBB);
+        Bitboard checkers = attackersTo(state, king, occupied) & theirs;
+
+        // The king may step anywhere the enemy doesn't attack once it has left its square
+        Bitboard targets = kingAttacks(king) & kindMask;
+        while (targets) {
+            int to = popLsb(targets);
+            if (!(attackersTo(state, to, occupied ^ kingBB) & theirs)) {
+                list.push(Move(king, to));
+            }
+        }
+
+        // Only a king move can answer a double check
+        if (popCount(checkers) > 1) return;
+
+        if (checkers) {
+            checkMask = betweenBB(king, lsb(checkers)) | checkers;
+        } else if (type != CAPTURES) {
+            generateCastling(state, us, king, occupied, list);
+        }
+
+        // A piece is pinned when it is the only thing between the king and an enemy slider
+        Bitboard snipers = ((rookAttacks(king, 0) & (state.pieces[them][ROOK] | state.pieces[them][QUEEN]))
+                          | (bishopAttacks(king, 0) & (state.pieces[them][BISHOP] | state.pieces[them][QUEEN])));
+        while (snipers) {
+            int sniper = popLsb(snipers);
+            Bitboard blockers = betweenBB(king, sniper) & occupied;
+            if (blockers && !(blockers & (blockers - 1)) && (blockers & ours)) {
+                pinned |= blockers;
+                pinMask[lsb(blockers)] = betweenBB(king, sniper) | squareBB(sniper);
+            }
+        }
+    }
+
+    // Knights, bishops, rooks and queens
+    for (int pieceType = KNIGHT; pieceType <= QUEEN; ++pieceType) {
+        Bitboard pieces = state.pieces[us][pieceType];
+        while (pieces) {
+            int from = popLsb(pieces);
+            Bitboard targets;
+            if (pieceType == KNIGHT) {
+                targets = knightAttacks(from);
+            } else if (pieceType == BISHOP) {
+                targets = bishopAttacks(from, occupied);
+            } else if (pieceType == ROOK) {
+                targets = rookAttacks(from, occupied);
+            } else {
+                targets = queenAttacks(from, occupied);
+            }
+
+            targets &= kindMask & checkMask;
+            if (pinned & squareBB(from)) targets &= pinMask[from];
+            while (targets) {
+                list.push(Move(from, popLsb(targets)));
+            }
+        }
+    }
+
+    // Pawns. A pawn on its starting rank may advance two squares. Pushes to
+    // the last rank are promotions and so count as captures.
+    int forward = (us == WHITE) ? 8 : -8;
+    int startRank = (us == WHITE) ? 1 : 6;
+    int epSquare = enPassantSquare(state, us);
+    Bitboard pawns = state.pieces[us][PAWN];
+    while (pawns) {
+        int from = popLsb(pawns);
+        Bitboard allowed = checkMask;
+        if (pinned & squareBB(from)) allowed &= pinMask[from];
+
+        int to = from + forward;
+        bool promotes = (to >> 3) == 0 || (to >> 3) == 7;
+        if (to >= 0 && to < 64 && !(occupied & squareBB(to)) && (promotes ? type != QUIETS : type != CAPTURES)) {
+            if (allowed & squareBB(to)) {
+                pushPawnMove(list, from, to);
+            }
+            int twoSquares = to + forward;
+            if ((from >> 3) == startRank && !(occupied & squareBB(twoSquares)) && (allowed & squareBB(twoSquares))) {
+                list.push(Move(from, twoSquares));
+            }
+        }
+
+        if (type == QUIETS) {
+            continue;
+        }
+
+        Bitboard captures = pawnAttacks(us, from) & theirs & allowed;
+        while (captures) {
+            pushPawnMove(list, from, popLsb(captures));
+        }
+
+        // En passant removes two pawns from one rank, so test it on the resulting occupancy
+        if (epSquare >= 0 && (pawnAttacks(us, from) & squareBB(epSquare))) {
+            int capturedSquare = epSquare - forward;
+            if (king < 0) {
+                list.push(Move(from, epSquare, EN_PASSANT));
+                continue;
+            }
+            Bitboard after = (occupied ^ squareBB(from) ^ squareBB(capturedSquare)) | squareBB(epSquare);
+            if (!(attackersTo(state, king, after) & theirs & ~squareBB(capturedSquare))) {
+                list.push(Move(from, epSquare, EN_PASSANT));
+            }
+        }
+    }
+}
@@ -0,0 +1,137 @@
+#include "movepicker.h"
+#include "pieces.h"
+#include <algorithm>
+
+static const Move NO_MOVE(0, 0);
+static const Move NO_KILLERS[2] = {NO_MOVE, NO_MOVE};
+
+// Swaps the best scored move from index onwards into index and returns it
+static Move pickBest(MoveList& list, int* scores, int& index) {
+    int best = index;
+    for (int i = index + 1; i < list.size(); ++i) {
+        if (scores[i] > scores[best]) {
+            best = i;
+        }
+    }
+    std::swap(list.moves[index], list.moves[best]);
+    std::swap(scores[index], scores[best]);
+    return list.moves[index++];
+}
+
+static bool contains(const MoveList& list, Move move) {
+    return std::find(list.begin(), list.end(), move) != list.end();
+}
+
+MovePicker::MovePicker(const BoardState& state, Move hashMove, const Move* killers, const ButterflyHistory& history)
+    : state(state), us(state.whiteTurn ? WHITE : BLACK), hashMove(hashMove), killers{killers[0], killers[1]},
+      history(history), stage(HASH_MOVE), killerIndex(0), nextCapture(0), nextQuiet(0),
+      capturesGenerated(false), quietsGenerated(false), capturesOnly(false) {}
+
+MovePicker::MovePicker(const BoardState& state, const ButterflyHistory& history)
+    : MovePicker(state, NO_MOVE, NO_KILLERS, history) {
+    stage = GENERATE_CAPTURES;
+    capturesOnly = true;
+}
+
+// Most valuable victim first, and for the same victim the least valuable
+// attacker. A promotion counts the piece it creates as taken.
+void MovePicker::generateCaptures() {
+    generateLegalMoves(state, us, captures, CAPTURES);
+    for (int i = 0; i < captures.size(); ++i) {
+        const Move& move = captures[i];
+        int victim = 0;
+        if (move.flag() == EN_PASSANT) {
+            victim = Piece(PAWN, true).getValue();
+        } else if (state.mailbox[move.to()] != NO_PIECE) {
+            victim = Piece(state.mailbox[move.to()]).getValue();
+        }
+        if (move.isPromotion()) {
+            victim += Piece(move.promotion(), true).getValue();
+        }
+        captureScores[i] = victim * 128 - Piece(state.mailbox[move.from()]).getValue();
+    }
+    capturesGenerated = true;
+}
+
+void MovePicker::generateQuiets() {
+    generateLegalMoves(state, us, quiets, QUIETS);
+    quietsGenerated = true;
+}
+
+Move MovePicker::next() {
+    while (true) {
+        switch (stage) {
+        case HASH_MOVE:
+            stage = GENERATE_CAPTURES;
+            if (hashMove != NO_MOVE) {
+                // The hash move may come from another position with the same
+                // key, so only return it once it is found among the legal moves
+                // of its kind. That list is needed later anyway.
+                if (isQuiet(state, hashMove)) {
+                    generateQuiets();
+                    if (contains(quiets, hashMove)) {
+                        return hashMove;
+                    }
+                } else {
+                    generateCaptures();
+                    if (contains(captures, hashMove)) {
+                        return hashMove;
+                    }
+                }
+                hashMove = NO_MOVE;
+            }
+            break;
+
+        case GENERATE_CAPTURES:
+            if (!capturesGenerated) {
+                generateCaptures();
+            }
+            stage = PICK_CAPTURES;
+            break;
+
+        case PICK_CAPTURES:
+            while (nextCapture < captures.size()) {
+                Move move = pickBest(captures, captureScores, nextCapture);
+                if (move != hashMove) {
+                    return move;
+                }
+            }
+            stage = capturesOnly ? DONE : KILLERS;
+            break;
+
+        case KILLERS:
+            if (!quietsGenerated) {
+                generateQuiets();
+            }
+            while (killerIndex < 2) {
+                Move killer = killers[killerIndex++];
+                if (killer != NO_MOVE && killer != hashMove && (killerIndex == 1 || killer != killers[0])
+                    && contains(quiets, killer)) {
+                    return killer;
+                }
+            }
+            stage = SCORE_QUIETS;
+            break;
+
+        case SCORE_QUIETS:
+            for (int i = 0; i < quiets.size(); ++i) {
+                quietScores[i] = history[us][quiets[i].from()][quiets[i].to()];
+            }
+            stage = PICK_QUIETS;
+            break;
+
+        case PICK_QUIETS:
+            while (nextQuiet < quiets.size()) {
+                Move move = pickBest(quiets, quietScores, nextQuiet);
+                if (move != hashMove && move != killers[0] && move != killers[1]) {
+                    return move;
+                }
+            }
+            stage = DONE;
+            break;
+
+        case DONE:
+            return NO_MOVE;
+        }
+    }
+}
@@ -0,0 +1,261 @@
+#include "nnue.h"
+#include <algorithm>
+#include <fstream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define NNUE_X86
+#endif
+
+// Quantization: hidden activations are clipped to [0, QA] and output weights
+// are scaled by QB, so the output sum is on the scale of QA * QB
+const int QA = 255;
+const int QB = 64;
+const int OUTPUT_SCALE = 400;
+
+struct Network::Weights {
+    int16_t inputWeights[NNUE_INPUTS][NNUE_HIDDEN];
+    int16_t hiddenBias[NNUE_HIDDEN];
+    int16_t outputWeights[2 * NNUE_HIDDEN];
+    int16_t outputBias;
+};
+
+Network network;
+
+// The two loops every evaluation runs: adding and subtracting weight rows
+// from an accumulator, and the clipped dot product of the accumulator with
+// the output weights. Each comes as plain C++ and, on x86, as SSE2 and AVX2
+// versions compiled for their instruction set regardless of the build flags.
+// The fastest one the CPU runs is picked once at startup.
+struct Kernels {
+    const char* name;
+    void (*addSub)(int16_t* out, const int16_t* in, const int16_t* const* add, int addCount,
+                   const int16_t* const* sub, int subCount);
+    int32_t (*output)(const int16_t* us, const int16_t* them, const int16_t* weights);
+};
+
+static void addSubScalar(int16_t* out, const int16_t* in, const int16_t* const* add, int addCount,
+                         const int16_t* const* sub, int subCount) {
+    for (int i = 0; i < NNUE_HIDDEN; ++i) {
+        int16_t value = in[i];
+        for (int k = 0; k < addCount; ++k) {
+            value += add[k][i];
+        }
+        for (int k = 0; k < subCount; ++k) {
+            value -= sub[k][i];
+        }
+        out[i] = value;
+    }
+}
+
+static int32_t outputScalar(const int16_t* us, const int16_t* them, const int16_t* weights) {
+    int32_t sum = 0;
+    for (int i = 0; i < NNUE_HIDDEN; ++i) {
+        sum += std::min(std::max(int(us[i]), 0), QA) * weights[i];
+        sum += std::min(std::max(int(them[i]), 0), QA) * weights[NNUE_HIDDEN + i];
+    }
+    return sum;
+}
+
+#ifdef NNUE_X86
+__attribute__((target("sse2")))
+static void addSubSse2(int16_t* out, const int16_t* in, const int16_t* const* add, int addCount,
+                       const int16_t* const* sub, int subCount) {
+    for (int i = 0; i < NNUE_HIDDEN; i += 8) {
+        __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        for (int k = 0; k < addCount; ++k) {
+            value = _mm_add_epi16(value, _mm_loadu_si128(reinterpret_cast<const __m128i*>(add[k] + i)));
+        }
+        for (int k = 0; k < subCount; ++k) {
+            value = _mm_sub_epi16(value, _mm_loadu_si128(reinterpret_cast<const __m128i*>(sub[k] + i)));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), value);
+    }
+}
+
+__attribute__((target("sse2")))
+static int32_t outputSse2(const int16_t* us, const int16_t* them, const int16_t* weights) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i qa = _mm_set1_epi16(QA);
+    __m128i sum = _mm_setzero_si128();
+    const int16_t* halves[2] = {us, them};
+    for (int half = 0; half < 2; ++half) {
+        for (int i = 0; i < NNUE_HIDDEN; i += 8) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(halves[half] + i));
+            x = _mm_min_epi16(_mm_max_epi16(x, zero), qa);
+            __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + half * NNUE_HIDDEN + i));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(x, w));
+        }
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+}
+
+__attribute__((target("avx2")))
+static void addSubAvx2(int16_t* out, const int16_t* in, const int16_t* const* add, int addCount,
+                       const int16_t* const* sub, int subCount) {
+    for (int i = 0; i < NNUE_HIDDEN; i += 16) {
+        __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        for (int k = 0; k < addCount; ++k) {
+            value = _mm256_add_epi16(value, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(add[k] + i)));
+        }
+        for (int k = 0; k < subCount; ++k) {
+            value = _mm256_sub_epi16(value, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sub[k] + i)));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), value);
+    }
+}
+
+__attribute__((target("avx2")))
+static int32_t outputAvx2(const int16_t* us, const int16_t* them, const int16_t* weights) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i qa = _mm256_set1_epi16(QA);
+    __m256i sum = _mm256_setzero_si256();
+    const int16_t* halves[2] = {us, them};
+    for (int half = 0; half < 2; ++half) {
+        for (int i = 0; i < NNUE_HIDDEN; i += 16) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(halves[half] + i));
+            x = _mm256_min_epi16(_mm256_max_epi16(x, zero), qa);
+            __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + half * NNUE_HIDDEN + i));
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(x, w));
+        }
+    }
+    __m128i total = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    total = _mm_add_epi32(total, _mm_shuffle_epi32(total, 0x4E));
+    total = _mm_add_epi32(total, _mm_shuffle_epi32(total, 0xB1));
+    return _mm_cvtsi128_si32(total);
+}
+#endif
+
+static Kernels pickKernels() {
+#ifdef NNUE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return {"avx2", addSubAvx2, outputAvx2};
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return {"sse2", addSubSse2, outputSse2};
+    }
+#endif
+    return {"scalar", addSubScalar, outputScalar};
+}
+
+static const Kernels kernels = pickKernels();
+
+static int featureIndex(Color perspective, uint8_t code, int square) {
+    return 384 * (pieceCodeColor(code) != perspective) + 64 * pieceCodeType(code)
+         + (perspective == WHITE ? square : square ^ 56);
+}
+
+DirtyPieces dirtyPiecesOf(const BoardState& before, const Move& move) {
+    DirtyPieces dirty = {};
+    int from = move.from();
+    int to = move.to();
+    uint8_t moved = before.mailbox[from];
+    auto lift = [&](uint8_t code, int square) {
+        dirty.removed[dirty.removedCount][0] = code;
+        dirty.removed[dirty.removedCount++][1] = uint8_t(square);
+    };
+    auto drop = [&](uint8_t code, int square) {
+        dirty.added[dirty.addedCount][0] = code;
+        dirty.added[dirty.addedCount++][1] = uint8_t(square);
+    };
+
+    lift(moved, from);
+    if (move.flag() == EN_PASSANT) {
+        int capturedSquare = squareOf(to & 7, from >> 3);
+        lift(before.mailbox[capturedSquare], capturedSquare);
+    } else if (before.mailbox[to] != NO_PIECE) {
+        lift(before.mailbox[to], to);
+    }
+
+    if (move.flag() == CASTLING) {
+        int rookFrom = to > from ? to + 1 : to - 2;
+        int rookTo = to > from ? to - 1 : to + 1;
+        lift(before.mailbox[rookFrom], rookFrom);
+        drop(before.mailbox[rookFrom], rookTo);
+    }
+    drop(move.isPromotion() ? makePieceCode(pieceCodeColor(moved), move.promotion()) : moved, to);
+    return dirty;
+}
+
+Network::Network() {}
+
+Network::~Network() {}
+
+bool Network::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+
+    // Trainers may pad the file to a multiple of 64 bytes. The weights are
+    // read as they lie on disk, which assumes a little-endian CPU.
+    size_t expected = sizeof(Weights::inputWeights) + sizeof(Weights::hiddenBias)
+                    + sizeof(Weights::outputWeights) + sizeof(Weights::outputBias);
+    size_t size = size_t(file.tellg());
+    if (size < expected || size >= expected + 64) {
+        return false;
+    }
+
+    std::unique_ptr<Weights> loadedWeights(new Weights());
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(loadedWeights->inputWeights), sizeof(Weights::inputWeights));
+    file.read(reinterpret_cast<char*>(loadedWeights->hiddenBias), sizeof(Weights::hiddenBias));
+    file.read(reinterpret_cast<char*>(loadedWeights->outputWeights), sizeof(Weights::outputWeights));
+    file.read(reinterpret_cast<char*>(&loadedWeights->outputBias), sizeof(Weights::outputBias));
+    if (!file) {
+        return false;
+    }
+
+    weights = std::move(loadedWeights);
+    return true;
+}
+
+void Network::unload() {
+    weights.reset();
+}
+
+void Network::refresh(const BoardState& state, Accumulator& accumulator) const {
+    for (int perspective = WHITE; perspective <= BLACK; ++perspective) {
+        int16_t* values = accumulator.values[perspective];
+        std::copy(weights->hiddenBias, weights->hiddenBias + NNUE_HIDDEN, values);
+
+        // Rows are added in batches, since setup mode allows any number of pieces
+        const int16_t* rows[16];
+        int count = 0;
+        Bitboard occupied = state.occupied();
+        while (occupied) {
+            int square = popLsb(occupied);
+            rows[count++] = weights->inputWeights[featureIndex(Color(perspective), state.mailbox[square], square)];
+            if (count == 16 || !occupied) {
+                kernels.addSub(values, values, rows, count, nullptr, 0);
+                count = 0;
+            }
+        }
+    }
+}
+
+void Network::update(const Accumulator& parent, const DirtyPieces& dirty, Accumulator& child) const {
+    for (int perspective = WHITE; perspective <= BLACK; ++perspective) {
+        const int16_t* added[2];
+        const int16_t* removed[2];
+        for (int i = 0; i < dirty.addedCount; ++i) {
+            added[i] = weights->inputWeights[featureIndex(Color(perspective), dirty.added[i][0], dirty.added[i][1])];
+        }
+        for (int i = 0; i < dirty.removedCount; ++i) {
+            removed[i] = weights->inputWeights[featureIndex(Color(perspective), dirty.removed[i][0], dirty.removed[i][1])];
+        }
+        kernels.addSub(child.values[perspective], parent.values[perspective], added, dirty.addedCount, removed, dirty.removedCount);
+    }
+}
+
+int Network::evaluate(const Accumulator& accumulator, Color sideToMove) const {
+    int32_t sum = kernels.output(accumulator.values[sideToMove], accumulator.values[sideToMove ^ 1], weights->outputWeights);
+    return int((int64_t(sum) + weights->outputBias) * OUTPUT_SCALE / (QA * QB));
+}
+
+const char* Network::kernelName() {
+    return kernels.name;
+}
@@ -4,9 +4,13 @@
 #include <ctime>
 #include <algorithm>
 #include <random>
+#include <iomanip>
 #include "board.h"
 #include "player.h"
+#include "book.h"
 #include "playeraction.h"
+#include "search.h"
+#include "tablebase.h"
 
 bool HumanPlayer::makeAction(Board& board) {
     std::string command;
@@ -34,13 +38,13 @@ bool HumanPlayer::makeAction(Board& board) {
         Position start(from[0] - 'a', from[1] - '1');
         Position end(to[0] - 'a', to[1] - '1');
 
-        auto piece = board.at(start);
+        Piece piece = board.at(start);
         if (!piece) {
             std::cout << "No piece at the starting position. Try again." << std::endl;
             return makeAction(board);
         }
 
-        if (piece->getIsWhite() != isWhite) {
+        if (piece.getIsWhite() != isWhite) {
             std::cout << "Not your piece. Try again." << std::endl;
             return makeAction(board);
         }
@@ -50,9 +54,8 @@ bool HumanPlayer::makeAction(Board& board) {
             return makeAction(board);
         }
 
-        if (piece->getSymbol() == (isWhite ? 'P' : 'p') && (end.y == 0 || end.y == 7)) {
-            auto pawn = std::dynamic_pointer_cast<Pawn>(piece);
-            pawn->promote(end, board, promotion);
+        if (piece.getType() == PAWN && (end.y == 0 || end.y == 7)) {
+            promotePawn(end, board, promotion);
         }
 
         return true;
@@ -65,6 +68,26 @@ bool HumanPlayer::makeAction(Board& board) {
     }
 }
 
+// How often a searching player hands control back to the game
+const int IDLE_INTERVAL_MS = 10;
+
+// One line summary of the search behind a move
+static void printSearchResult(const SearchResult& result) {
+    std::cout << "Depth " << result.depth << ", score ";
+    if (std::abs(result.score) >= MATE_BOUND) {
+        int moves = (MATE_SCORE - std::abs(result.score) + 1) / 2;
+        std::cout << (result.score > 0 ? "mate in " : "mated in ") << moves;
+    } else {
+        std::cout << std::showpos << std::fixed << std::setprecision(2) << result.score / 100.0
+                  << std::noshowpos << std::defaultfloat;
+    }
+    std::cout << ", " << result.nodes << " nodes:";
+    for (const Move& move : result.pv) {
+        std::cout << " " << move.toString();
+    }
+    std::cout << std::endl;
+}
+
 bool ComputerPlayer::makeAction(Board& board) {
     std::string command;
     std::cout << "Computer " << (isWhite ? "(White)" : "(Black)") << ": Enter command (resign or move): ";
@@ -80,98 +103,202 @@ bool ComputerPlayer::makeAction(Board& board) {
         std::cout << (isWhite ? "White" : "Black") << " resigns." << std::endl;
         return false;
     } else if (action == "move") {
-        auto actions = board.getPossibleActions(isWhite);
         std::srand(std::time(nullptr));
+        int pondered = ponderHitMs;
+        ponderHitMs = 0;
+        expectedReply = Move(0, 0);
 
-        playerAction randomMove;
-        if (difficulty == 1) {
-            // Level 1: Random legal moves
-            randomMove = actions[std::rand() % actions.size()];
-            board.movePiece(randomMove.start, randomMove.end);
-        } else if (difficulty == 2) {
-            // Level 2: Prefer capturing moves and checks over other moves
-            std::vector<playerAction> captures, checks, others;
-            for (const auto& action : actions) {
-                if (action.isCapture) {
-                    captures.push_back(action);
-                } else if (action.isCheck) {
-                    checks.push_back(action);
-                } else {
-                    others.push_back(action);
-                }
+        // Known opening moves are played straight from the book
+        Move chosen(0, 0);
+        if (openingBook.isOpen() && movesPlayed < openingBook.getMaxMoves()) {
+            chosen = openingBook.probe(board);
+            if (chosen != Move(0, 0)) {
+                std::cout << "Book move " << chosen.toString() << std::endl;
             }
-            if (!captures.empty()) {
-                randomMove = captures[std::rand() % captures.size()];
-                board.movePiece(randomMove.start, randomMove.end);
-            } else if (!checks.empty()) {
-                randomMove = checks[std::rand() % checks.size()];
-                board.movePiece(randomMove.start, randomMove.end);
+        }
+
+        // Endgames in the tables are played perfectly at every level
+        TBResult tbResult;
+        if (chosen == Move(0, 0) && tablebases.probeRoot(board.getState(), chosen, tbResult)) {
+            std::cout << "Tablebase move " << chosen.toString();
+            if (tbResult.outcome > 0) {
+                std::cout << " (mate in " << (tbResult.pliesToMate + 1) / 2 << ")";
+            } else if (tbResult.outcome < 0) {
+                std::cout << " (mated in " << tbResult.pliesToMate / 2 << ")";
             } else {
-                randomMove = others[std::rand() % others.size()];
-                board.movePiece(randomMove.start, randomMove.end);
+                std::cout << " (draw)";
             }
-        } else if (difficulty == 3) {
-            // Level 3: Prefer avoiding capture, capturing moves, and checks
-            std::vector<playerAction> captures, checks, safeMoves, others;
-            for (const auto& action : actions) {
-                if (action.isCapture) {
-                    captures.push_back(action);
-                } else if (action.isCheck) {
-                    checks.push_back(action);
-                } else if (!action.canBeCaptured) {
-                    safeMoves.push_back(action);
+            std::cout << std::endl;
+        }
+
+        if (chosen == Move(0, 0)) {
+            if (difficulty == 1) {
+                // Level 1: Random legal moves, read straight off the move generator
+                MoveList moves, candidates;
+                generateLegalMoves(board.getState(), isWhite ? WHITE : BLACK, moves);
+                for (const Move& move : moves) {
+                    // Always promote to queen
+                    if (!move.isPromotion() || move.promotion() == QUEEN) {
+                        candidates.push(move);
+                    }
+                }
+                chosen = candidates[std::rand() % candidates.size()];
+            } else if (difficulty == 2) {
+                // Level 2: Prefer capturing moves and checks over other moves
+                PlayerActions actions(board, isWhite);
+                MoveList captures, checks, others;
+                for (int i = 0; i < actions.size(); ++i) {
+                    if (actions.isCapture(i)) {
+                        captures.push(actions[i]);
+                    } else if (actions.givesCheck(i)) {
+                        checks.push(actions[i]);
+                    } else {
+                        others.push(actions[i]);
+                    }
+                }
+                if (!captures.empty()) {
+                    chosen = captures[std::rand() % captures.size()];
+                } else if (!checks.empty()) {
+                    chosen = checks[std::rand() % checks.size()];
                 } else {
-                    others.push_back(action);
+                    chosen = others[std::rand() % others.size()];
+                }
+            } else if (difficulty == 3) {
+                // Level 3: Prefer moves that don't lose material, then captures and checks
+                PlayerActions actions(board, isWhite);
+                MoveList captures, checks, safeMoves, others;
+                for (int i = 0; i < actions.size(); ++i) {
+                    if (actions.isCapture(i)) {
+                        captures.push(actions[i]);
+                    } else if (actions.givesCheck(i)) {
+                        checks.push(actions[i]);
+                    } else if (!actions.losesMaterial(i)) {
+                        safeMoves.push(actions[i]);
+                    } else {
+                        others.push(actions[i]);
+                    }
+                }
+                if (!safeMoves.empty()) {
+                    chosen = safeMoves[std::rand() % safeMoves.size()];
+                } else if (!captures.empty()) {
+                    chosen = captures[std::rand() % captures.size()];
+                } else if (!checks.empty()) {
+                    chosen = checks[std::rand() % checks.size()];
+                } else {
+                    chosen = others[std::rand() % others.size()];
+                }
+            } else if (difficulty == 4) {
+                // Level 4: Use action scores to select the best move with some randomness
+                PlayerActions actions(board, isWhite);
+                int totalScore = 0;
+                for (int i = 0; i < actions.size(); ++i) {
+                    totalScore += actions.score(i) + 1; // Add 1 to avoid zero scores
                 }
-            }
-            if (!safeMoves.empty()) {
-                randomMove = safeMoves[std::rand() % safeMoves.size()];
-                board.movePiece(randomMove.start, randomMove.end);
-            } else if (!captures.empty()) {
-                randomMove = captures[std::rand() % captures.size()];
-                board.movePiece(randomMove.start, randomMove.end);
-            } else if (!checks.empty()) {
-                randomMove = checks[std::rand() % checks.size()];
-                board.movePiece(randomMove.start, randomMove.end);
-            } else {
-                randomMove = others[std::rand() % others.size()];
-                board.movePiece(randomMove.start, randomMove.end);
-            }
-        } else if (difficulty == 4) {
-            // Level 4: Use action scores to select the best move with some randomness
-            int totalScore = 0;
-            for (const auto& action : actions) {
-                totalScore += action.score + 1; // Add 1 to avoid zero scores
-            }
 
-            std::random_device rd;
-            std::mt19937 gen(rd());
-            std::uniform_int_distribution<> dis(0, totalScore - 1);
+                std::random_device rd;
+                std::mt19937 gen(rd());
+                std::uniform_int_distribution<> dis(0, totalScore - 1);
 
-            int randomScore = dis(gen);
-            int cumulativeScore = 0;
+                int randomScore = dis(gen);
+                int cumulativeScore = 0;
 
-            for (const auto& action : actions) {
-                cumulativeScore += action.score + 1;
-                if (cumulativeScore > randomScore) {
-                    randomMove = action;
-                    break;
+                for (int i = 0; i < actions.size(); ++i) {
+                    cumulativeScore += actions.score(i) + 1;
+                    if (cumulativeScore > randomScore) {
+                        chosen = actions[i];
+                        break;
+                    }
                 }
-            }
-
-            board.movePiece(randomMove.start, randomMove.end);
-        }
+            } else {
+                // Level 5 and up: alpha-beta search, each level thinking four times longer than the last
+                SearchLimits limits;
+                limits.timeMs = 100 << (2 * (difficulty - 5));
 
-        auto piece = board.at(randomMove.start);
-        if (piece && piece->getSymbol() == (isWhite ? 'P' : 'p') && (randomMove.end.y == 0 || randomMove.end.y == 7)) {
-            auto pawn = std::dynamic_pointer_cast<Pawn>(piece);
-            if (pawn) {
-                pawn->promote(randomMove.end, board, "Q"); // Always promote to queen
+                // Time spent pondering this position counts against the budget,
+                // and the pondered result stands if it went deeper
+                SearchResult result;
+                if (pondered >= limits.timeMs && ponderResult.depth > 0) {
+                    result = ponderResult;
+                } else {
+                    limits.timeMs = std::max(limits.timeMs - pondered, limits.timeMs / 10);
+                    Search search(tt, threads);
+                    std::future<SearchResult> thinking = search.runAsync(board, limits);
+                    SearchInterrupt interrupt = SearchInterrupt::None;
+                    while (thinking.wait_for(std::chrono::milliseconds(IDLE_INTERVAL_MS)) != std::future_status::ready) {
+                        interrupt = idleHandler ? idleHandler() : SearchInterrupt::None;
+                        if (interrupt != SearchInterrupt::None) {
+                            search.stop();
+                            break;
+                        }
+                    }
+                    result = thinking.get();
+                    if (interrupt == SearchInterrupt::Abort) {
+                        // Back to this player's console prompt, where the
+                        // next "move" searches afresh
+                        std::cout << "Search aborted." << std::endl;
+                        return makeAction(board);
+                    }
+                    if (pondered && ponderResult.depth > result.depth) {
+                        result = ponderResult;
+                    }
+                }
+                chosen = result.bestMove;
+                if (result.pv.size() > 1) {
+                    expectedReply = result.pv[1];
+                }
+                printSearchResult(result);
             }
         }
+
+        // Queen promotions are part of the chosen move
+        board.movePiece(chosen);
+        ++movesPlayed;
         return true;
     } else {
         std::cout << "Unknown command. Try again." << std::endl;
         return makeAction(board);
     }
 }
+
+ComputerPlayer::~ComputerPlayer() {
+    endPondering();
+}
+
+void ComputerPlayer::ponder(const Board& board) {
+    endPondering();
+    ponderHitMs = 0;
+    MoveList moves;
+    generateLegalMoves(board.getState(), board.isWhiteTurn() ? WHITE : BLACK, moves);
+    if (difficulty < 5 || std::find(moves.begin(), moves.end(), expectedReply) == moves.end()) {
+        return;
+    }
+
+    // Searches without limits until stopped
+    Board position(board);
+    position.makeMove(expectedReply);
+    ponderKey = position.hash();
+    ponderSearch.reset(new Search(tt, threads));
+    ponderStart = std::chrono::steady_clock::now();
+    pondering = ponderSearch->runAsync(position, SearchLimits());
+}
+
+void ComputerPlayer::stopPondering(const Board& board) {
+    if (!pondering.valid()) {
+        return;
+    }
+    endPondering();
+    ponderSearch.reset();
+    if (board.hash() == ponderKey) {
+        auto elapsed = std::chrono::steady_clock::now() - ponderStart;
+        ponderHitMs = std::max(1, int(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()));
+        std::cout << "Ponder hit: " << expectedReply.toString() << " searched to depth "
+                  << ponderResult.depth << " while waiting" << std::endl;
+    }
+}
+
+void ComputerPlayer::endPondering() {
+    if (pondering.valid()) {
+        ponderSearch->stop();
+        ponderResult = pondering.get();
+    }
+}
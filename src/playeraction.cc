@@ -0,0 +1,68 @@
+#include "playeraction.h"
+#include <cstring>
+
+PlayerActions::PlayerActions(const Board& board, bool isWhite) : scratch(board), isWhite(isWhite) {
+    MoveList all;
+    generateLegalMoves(board.getState(), isWhite ? WHITE : BLACK, all);
+    for (const Move& move : all) {
+        if (!move.isPromotion() || move.promotion() == QUEEN) {
+            moves.push(move);
+        }
+    }
+    std::memset(known, 0, moves.size());
+    std::memset(flags, 0, moves.size());
+}
+
+bool PlayerActions::annotation(int i, Annotation annotation) {
+    if (!(known[i] & annotation)) {
+        const Move& move = moves[i];
+        bool value;
+        if (annotation == CAPTURE) {
+            value = move.flag() == EN_PASSANT || scratch.getState().mailbox[move.to()] != NO_PIECE;
+        } else if (annotation == LOSES_MATERIAL) {
+            value = scratch.see(move) < 0;
+        } else {
+            // The rest need the move on the board
+            scratch.makeMove(move);
+            if (annotation == GIVES_CHECK) {
+                value = scratch.isCheck(!isWhite);
+            } else {
+                value = scratch.isCheckmate(!isWhite);
+            }
+            scratch.unmakeMove();
+        }
+        known[i] |= annotation;
+        if (value) {
+            flags[i] |= annotation;
+        }
+    }
+    return flags[i] & annotation;
+}
+
+bool PlayerActions::isCapture(int i) {
+    return annotation(i, CAPTURE);
+}
+
+bool PlayerActions::givesCheck(int i) {
+    return annotation(i, GIVES_CHECK);
+}
+
+bool PlayerActions::losesMaterial(int i) {
+    return annotation(i, LOSES_MATERIAL);
+}
+
+bool PlayerActions::isMate(int i) {
+    return annotation(i, MATE);
+}
+
+int PlayerActions::score(int i) const {
+    const Move& move = moves[i];
+    const uint8_t* mailbox = scratch.getState().mailbox;
+    int value = Piece(mailbox[move.from()]).getValue();
+    if (move.flag() == EN_PASSANT) {
+        value += Piece(PAWN, !isWhite).getValue();
+    } else if (mailbox[move.to()] != NO_PIECE) {
+        value += Piece(mailbox[move.to()]).getValue();
+    }
+    return value;
+}
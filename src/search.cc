@@ -0,0 +1,447 @@
+#include "search.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+// Rough piece values in centipawns, for delta pruning
+static const int materialValues[PIECE_TYPE_NB] = {100, 300, 300, 500, 900, 0};
+
+// A capture that leaves the side this far short of alpha, even after winning
+// the piece, is not worth searching in quiescence
+const int DELTA_MARGIN = 200;
+
+// Reverse and normal futility pruning apply this close to the horizon, with
+// a margin per ply of remaining depth
+const int FUTILITY_DEPTH = 3;
+const int FUTILITY_MARGIN = 150;
+
+// A null move cut at this depth or more is verified by a reduced search
+const int NULL_VERIFY_DEPTH = 8;
+
+// Late move reductions by remaining depth and move number, growing with the
+// logarithm of both
+static const struct ReductionTable {
+    int table[MAX_PLY][MoveList::CAPACITY];
+
+    ReductionTable() {
+        for (int depth = 0; depth < MAX_PLY; ++depth) {
+            for (int moves = 0; moves < MoveList::CAPACITY; ++moves) {
+                table[depth][moves] = depth && moves ? int(0.75 + std::log(depth) * std::log(moves) / 2.25) : 0;
+            }
+        }
+    }
+
+    const int* operator[](int depth) const { return table[depth]; }
+} reductions;
+
+// Mate scores are stored relative to the position, not the root, so they
+// stay right when the position is reached at another ply
+static int scoreToTT(int score, int ply) {
+    return score >= MATE_BOUND ? score + ply : score <= -MATE_BOUND ? score - ply : score;
+}
+
+static int scoreFromTT(int score, int ply) {
+    return score >= MATE_BOUND ? score - ply : score <= -MATE_BOUND ? score + ply : score;
+}
+
+uint64_t Search::totalNodes() const {
+    uint64_t total = 0;
+    for (const auto& worker : workers) {
+        total += worker->nodeCount();
+    }
+    return total;
+}
+
+bool Search::outOfBudget() const {
+    if (limits.nodes && totalNodes() >= limits.nodes) {
+        return true;
+    }
+    if (limits.timeMs) {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed >= std::chrono::milliseconds(limits.timeMs);
+    }
+    return false;
+}
+
+bool SearchWorker::enterNode(int ply) {
+    pvLength[ply] = ply;
+
+    // Only the main worker reads the clock, every 1024 nodes. A plain
+    // load and store keeps the counter cheap; only this thread writes it.
+    uint64_t count = nodes.load(std::memory_order_relaxed) + 1;
+    nodes.store(count, std::memory_order_relaxed);
+    if (id == 0 && (count & 1023) == 0 && search.outOfBudget()) {
+        search.stopped = true;
+    }
+    return !search.stopped.load(std::memory_order_relaxed);
+}
+
+void SearchWorker::makeMove(const Move& move, int ply) {
+    if (useNetwork) {
+        dirty[ply] = dirtyPiecesOf(board.getState(), move);
+        accumulatorReady[ply + 1] = false;
+    }
+    board.makeMove(move);
+}
+
+void SearchWorker::makeNullMove(int ply) {
+    if (useNetwork) {
+        dirty[ply] = DirtyPieces();
+        accumulatorReady[ply + 1] = false;
+    }
+    board.makeNullMove();
+}
+
+// The accumulator of a position is only brought up to date when the position
+// is evaluated, starting from the nearest ancestor whose accumulator is, so
+// moves that are cut off before their evaluation cost nothing
+int SearchWorker::staticEval(int ply) {
+    if (!useNetwork) {
+        return evaluate(board);
+    }
+    int ready = ply;
+    while (!accumulatorReady[ready]) {
+        --ready;
+    }
+    for (; ready < ply; ++ready) {
+        network.update(accumulators[ready], dirty[ready], accumulators[ready + 1]);
+        accumulatorReady[ready + 1] = true;
+    }
+    return network.evaluate(accumulators[ply], board.isWhiteTurn() ? WHITE : BLACK);
+}
+
+int SearchWorker::quiesce(int ply, int alpha, int beta) {
+    if (!enterNode(ply)) {
+        return 0;
+    }
+
+    bool inCheck = board.isCheck(board.isWhiteTurn());
+    if (ply >= MAX_PLY - 1) {
+        return inCheck ? 0 : staticEval(ply);
+    }
+
+    // Out of check the side to move may stand pat instead of capturing, so
+    // the static evaluation is a lower bound. In check every evasion is
+    // searched instead.
+    int standPat = -INFINITE_SCORE;
+    int best = -INFINITE_SCORE;
+    if (!inCheck) {
+        standPat = best = staticEval(ply);
+        if (best >= beta) {
+            return best;
+        }
+        alpha = std::max(alpha, best);
+    }
+
+    const BoardState& state = board.getState();
+    MovePicker picker = inCheck ? MovePicker(state, Move(0, 0), killers[ply], history) : MovePicker(state, history);
+    int moveCount = 0;
+    for (Move move = picker.next(); move != Move(0, 0); move = picker.next()) {
+        ++moveCount;
+        if (!inCheck) {
+            if (move.isPromotion() && move.promotion() != QUEEN) {
+                continue;
+            }
+            // Delta pruning, then captures that lose the exchange
+            int gain = 0;
+            if (move.flag() == EN_PASSANT) {
+                gain = materialValues[PAWN];
+            } else if (state.mailbox[move.to()] != NO_PIECE) {
+                gain = materialValues[pieceCodeType(state.mailbox[move.to()])];
+            }
+            if (move.isPromotion()) {
+                gain += materialValues[QUEEN] - materialValues[PAWN];
+            }
+            if (standPat + gain + DELTA_MARGIN <= alpha || board.see(move) < 0) {
+                continue;
+            }
+        }
+
+        makeMove(move, ply);
+        int score = -quiesce(ply + 1, -beta, -alpha);
+        board.unmakeMove();
+        if (search.stopped.load(std::memory_order_relaxed)) {
+            return 0;
+        }
+
+        if (score > best) {
+            best = score;
+            if (score > alpha) {
+                alpha = score;
+                pv[ply][ply] = move;
+                std::copy(pv[ply + 1] + ply + 1, pv[ply + 1] + pvLength[ply + 1], pv[ply] + ply + 1);
+                pvLength[ply] = pvLength[ply + 1];
+                if (alpha >= beta) {
+                    break;
+                }
+            }
+        }
+    }
+
+    if (inCheck && moveCount == 0) {
+        return -MATE_SCORE + ply;
+    }
+    return best;
+}
+
+int SearchWorker::negamax(int depth, int ply, int alpha, int beta, bool allowNull) {
+    if (depth <= 0) {
+        return quiesce(ply, alpha, beta);
+    }
+    if (!enterNode(ply)) {
+        return 0;
+    }
+
+    if (ply > 0 && board.isRepetition()) {
+        return 0;
+    }
+    if (ply >= MAX_PLY - 1) {
+        return staticEval(ply);
+    }
+
+    // Endgame tables give the exact result. A mate further than MAX_PLY from
+    // the root scores below MATE_BOUND, still above any evaluation.
+    TBResult tbResult;
+    if (ply > 0 && popCount(board.getState().occupied()) <= tablebases.maxPieces()
+        && tablebases.probe(board.getState(), tbResult)) {
+        return tbResult.outcome * (MATE_SCORE - ply - tbResult.pliesToMate);
+    }
+
+    // A deep enough stored result settles the node outright
+    uint64_t key = board.hash();
+    TTData entry;
+    Move ttMove(0, 0);
+    if (search.tt.probe(key, entry)) {
+        ttMove = entry.move;
+        int score = scoreFromTT(entry.score, ply);
+        if (ply > 0 && entry.depth >= depth
+            && (entry.bound == BOUND_EXACT
+                || (entry.bound == BOUND_LOWER && score >= beta)
+                || (entry.bound == BOUND_UPPER && score <= alpha))) {
+            return score;
+        }
+    }
+
+    const SearchOptions& options = search.options;
+    Color us = board.isWhiteTurn() ? WHITE : BLACK;
+    bool pvNode = beta - alpha > 1;
+    bool inCheck = board.isCheck(board.isWhiteTurn());
+    int eval = inCheck ? -INFINITE_SCORE : staticEval(ply);
+
+    if (!pvNode && !inCheck && std::abs(beta) < MATE_BOUND) {
+        // Reverse futility: so far above beta that no reply is likely to
+        // bring the score back down within the remaining depth
+        if (options.reverseFutility && depth <= FUTILITY_DEPTH && eval - FUTILITY_MARGIN * depth >= beta) {
+            return eval;
+        }
+
+        // Null move: if passing still holds beta, a real move would too. Not
+        // tried twice in a row, nor with only pawns left, where passing can
+        // be the better option (zugzwang). Deep enough nodes check the cut
+        // with a reduced search of their own moves before taking it.
+        Bitboard pieces = board.getState().byColor[us] & ~board.getState().pieces[us][PAWN] & ~board.getState().pieces[us][KING];
+        if (options.nullMove && allowNull && depth >= 3 && eval >= beta && pieces) {
+            int reduction = 3 + depth / 6;
+            makeNullMove(ply);
+            int score = -negamax(depth - 1 - reduction, ply + 1, -beta, -beta + 1, false);
+            board.unmakeNullMove();
+            if (search.stopped.load(std::memory_order_relaxed)) {
+                return 0;
+            }
+            if (score >= beta) {
+                if (score >= MATE_BOUND) {
+                    score = beta;
+                }
+                if (depth < NULL_VERIFY_DEPTH || negamax(depth - reduction, ply, beta - 1, beta, false) >= beta) {
+                    return score;
+                }
+            }
+        }
+    }
+
+    // Along the previous iteration's line try its move first, elsewhere the
+    // stored best move
+    if (followPv && ply >= previousPvLength) {
+        followPv = false;
+    }
+    MovePicker picker(board.getState(), followPv ? previousPv[ply] : ttMove, killers[ply], history);
+
+    // Near the leaves, quiet moves can't lift a hopeless position to alpha
+    bool futile = options.futility && !pvNode && !inCheck && depth <= FUTILITY_DEPTH
+        && std::abs(alpha) < MATE_BOUND && eval + FUTILITY_MARGIN * depth <= alpha;
+
+    int originalAlpha = alpha;
+    Move bestMove(0, 0);
+    int best = -INFINITE_SCORE;
+    int moveCount = 0;
+    Move quietsTried[MoveList::CAPACITY];
+    int quietCount = 0;
+    for (Move move = picker.next(); move != Move(0, 0); move = picker.next()) {
+        if (followPv && (moveCount > 0 || move != previousPv[ply])) {
+            followPv = false;
+        }
+        ++moveCount;
+        bool quiet = isQuiet(board.getState(), move);
+        int moveHistory = history[us][move.from()][move.to()];
+
+        makeMove(move, ply);
+        bool givesCheck = board.isCheck(board.isWhiteTurn());
+        if (futile && quiet && !givesCheck && moveCount > 1) {
+            board.unmakeMove();
+            continue;
+        }
+        search.tt.prefetch(board.hash());
+
+        // Principal variation search: the first move gets the full window,
+        // later ones only have to prove they are no better. Late quiet moves
+        // are first searched shallower, less so when their history is good.
+        int score;
+        if (moveCount == 1) {
+            score = -negamax(depth - 1, ply + 1, -beta, -alpha);
+        } else {
+            int reduction = 0;
+            if (options.lateMoveReductions && depth >= 3 && moveCount > 3 && quiet && !inCheck && !givesCheck) {
+                reduction = reductions[std::min(depth, MAX_PLY - 1)][std::min(moveCount, MoveList::CAPACITY - 1)];
+                reduction -= moveHistory / (HISTORY_MAX / 2);
+                reduction = std::max(0, std::min(reduction, depth - 2));
+            }
+            score = -negamax(depth - 1 - reduction, ply + 1, -alpha - 1, -alpha);
+            if (score > alpha && reduction) {
+                score = -negamax(depth - 1, ply + 1, -alpha - 1, -alpha);
+            }
+            if (score > alpha && score < beta) {
+                score = -negamax(depth - 1, ply + 1, -beta, -alpha);
+            }
+        }
+        board.unmakeMove();
+        if (search.stopped.load(std::memory_order_relaxed)) {
+            return 0;
+        }
+
+        if (score > best) {
+            best = score;
+            bestMove = move;
+            if (score > alpha) {
+                alpha = score;
+
+                // Extend the line below this move with the move itself
+                pv[ply][ply] = move;
+                std::copy(pv[ply + 1] + ply + 1, pv[ply + 1] + pvLength[ply + 1], pv[ply] + ply + 1);
+                pvLength[ply] = pvLength[ply + 1];
+                if (alpha >= beta) {
+                    // A quiet move that refutes this position is worth trying
+                    // early in its siblings too; the quiet moves that failed
+                    // before it lose some history
+                    if (quiet) {
+                        if (killers[ply][0] != move) {
+                            killers[ply][1] = killers[ply][0];
+                            killers[ply][0] = move;
+                        }
+                        int bonus = std::min(depth * depth, 400);
+                        updateHistory(history[us][move.from()][move.to()], bonus);
+                        for (int i = 0; i < quietCount; ++i) {
+                            updateHistory(history[us][quietsTried[i].from()][quietsTried[i].to()], -bonus);
+                        }
+                    }
+                    break;
+                }
+            }
+        }
+        if (quiet) {
+            quietsTried[quietCount++] = move;
+        }
+    }
+
+    if (moveCount == 0) {
+        return inCheck ? -MATE_SCORE + ply : 0;
+    }
+
+    Bound bound = best >= beta ? BOUND_LOWER : best > originalAlpha ? BOUND_EXACT : BOUND_UPPER;
+    search.tt.store(key, bestMove, scoreToTT(best, ply), depth, bound);
+    return best;
+}
+
+void SearchWorker::iterate(const Board& position) {
+    board = position;
+    nodes = 0;
+    previousPvLength = 0;
+    result = SearchResult();
+    std::fill(&killers[0][0], &killers[0][0] + MAX_PLY * 2, Move(0, 0));
+    std::memset(history, 0, sizeof(history));
+    useNetwork = network.loaded();
+    if (useNetwork) {
+        network.refresh(board.getState(), accumulators[0]);
+        accumulatorReady[0] = true;
+    }
+
+    MoveList moves;
+    generateLegalMoves(board.getState(), board.isWhiteTurn() ? WHITE : BLACK, moves);
+    if (moves.empty()) {
+        return;
+    }
+    result.bestMove = moves[0];
+
+    int maxDepth = search.limits.depth ? std::min(search.limits.depth, MAX_PLY - 1) : MAX_PLY - 1;
+    for (int depth = 1 + (id & 1); depth <= maxDepth; ++depth) {
+        followPv = true;
+        int score = negamax(depth, 0, -INFINITE_SCORE, INFINITE_SCORE);
+        if (search.stopped) {
+            break;
+        }
+
+        result.score = score;
+        result.depth = depth;
+        result.pv.assign(pv[0], pv[0] + pvLength[0]);
+        result.bestMove = pv[0][0];
+        std::copy(pv[0], pv[0] + pvLength[0], previousPv);
+        previousPvLength = pvLength[0];
+
+        // Searching deeper can't improve on a forced mate
+        if (std::abs(score) >= MATE_BOUND) {
+            break;
+        }
+    }
+}
+
+Search::Search(TranspositionTable& tt, int threads) : tt(tt), threadCount(std::max(1, threads)), stopped(false), stopRequested(false) {
+    for (int i = 0; i < threadCount; ++i) {
+        workers.emplace_back(new SearchWorker(*this, i));
+    }
+}
+
+SearchResult Search::run(const Board& position, const SearchLimits& searchLimits) {
+    limits = searchLimits;
+    start = std::chrono::steady_clock::now();
+    stopped = stopRequested.exchange(false);
+    tt.newSearch();
+
+    std::vector<std::thread> helpers;
+    for (int i = 1; i < threadCount; ++i) {
+        helpers.emplace_back(&SearchWorker::iterate, workers[i].get(), std::cref(position));
+    }
+
+    // The main worker decides when everyone stops
+    workers[0]->iterate(position);
+    stopped = true;
+    for (std::thread& helper : helpers) {
+        helper.join();
+    }
+
+    stopRequested = false;
+
+    SearchResult result = workers[0]->result;
+    result.nodes = totalNodes();
+    return result;
+}
+
+std::future<SearchResult> Search::runAsync(const Board& position, const SearchLimits& searchLimits) {
+    return std::async(std::launch::async, [this, position, searchLimits]() { return run(position, searchLimits); });
+}
+
+void Search::stop() {
+    stopRequested = true;
+    stopped = true;
+}
@@ -15,6 +15,9 @@ void SetupManager::enterSetupMode() {
         std::getline(std::cin, command);
         if (command == "done") {
             if (validateSetup()) {
+                // Drop castling and en passant claims the final placement rules out
+                board.setCastlingRights(board.getCastlingRights());
+                board.setEnPassantFile(board.getEnPassantFile());
                 std::cout << "Setup complete." << std::endl;
                 break;
             }
@@ -24,28 +27,6 @@ void SetupManager::enterSetupMode() {
     }
 }
 
-std::shared_ptr<Piece> SetupManager::createPiece(char pieceChar) {
-    bool isWhite = std::isupper(pieceChar);
-    char pieceType = std::tolower(pieceChar);
-
-    switch (pieceType) {
-        case 'k':
-            return std::make_shared<King>(isWhite);
-        case 'q':
-            return std::make_shared<Queen>(isWhite);
-        case 'r':
-            return std::make_shared<Rook>(isWhite);
-        case 'b':
-            return std::make_shared<Bishop>(isWhite);
-        case 'n':
-            return std::make_shared<Knight>(isWhite);
-        case 'p':
-            return std::make_shared<Pawn>(isWhite);
-        default:
-            return nullptr;
-    }
-}
-
 void SetupManager::processSetupCommand(const std::string& command) {
     std::istringstream iss(command);
     char action;
@@ -73,7 +54,7 @@ void SetupManager::processSetupCommand(const std::string& command) {
         int y = position[1] - '1';
         
         // Add piece to board
-        board.setPiece(Position(x, y), createPiece(piece));
+        board.setPiece(Position(x, y), Piece::fromSymbol(piece));
         std::cout << "Piece added." << std::endl;
 
     } else if (action == '-') {
@@ -108,6 +89,47 @@ void SetupManager::processSetupCommand(const std::string& command) {
             std::cout << "Invalid color. Use 'white' or 'black'." << std::endl;
         }
 
+    } else if (action == 'c') {
+        std::string rights;
+        iss >> rights;
+
+        // Castling rights in FEN style: any of 'KQkq', or '-' for none
+        int mask = NO_CASTLING;
+        for (char c : rights) {
+            if (c == 'K') mask |= WHITE_KING_SIDE;
+            else if (c == 'Q') mask |= WHITE_QUEEN_SIDE;
+            else if (c == 'k') mask |= BLACK_KING_SIDE;
+            else if (c == 'q') mask |= BLACK_QUEEN_SIDE;
+            else if (c != '-') mask = -1;
+        }
+        if (rights.empty() || mask < 0) {
+            std::cout << "Invalid castling rights. Use any of 'KQkq', or '-' for none." << std::endl;
+            return;
+        }
+        board.setCastlingRights(mask);
+        std::cout << "Castling rights set." << std::endl;
+
+    } else if (action == 'e') {
+        std::string square;
+        iss >> square;
+
+        // The square the pawn passed over, or '-' for none
+        if (square == "-") {
+            board.setEnPassantFile(NO_EN_PASSANT);
+            std::cout << "En passant cleared." << std::endl;
+            return;
+        }
+        int rank = board.isWhiteTurn() ? '6' : '3';
+        if (square.length() != 2 || square[0] < 'a' || square[0] > 'h' || square[1] != rank) {
+            std::cout << "Invalid en passant square. Use a square on rank " << char(rank) << ", or '-'." << std::endl;
+            return;
+        }
+        if (board.setEnPassantFile(square[0] - 'a')) {
+            std::cout << "En passant set." << std::endl;
+        } else {
+            std::cout << "No pawn can have just advanced past " << square << "." << std::endl;
+        }
+
     } else {
         std::cout << "Invalid setup command." << std::endl;
     }
@@ -120,11 +142,11 @@ bool SetupManager::validateSetup() const {
 
     for (int y = 0; y < 8; ++y) {
         for (int x = 0; x < 8; ++x) {
-            auto piece = board.at(x, y);
+            Piece piece = board.at(x, y);
             if (piece) {
-                if (piece->getSymbol() == 'K') whiteKingCount++;
-                if (piece->getSymbol() == 'k') blackKingCount++;
-                if (piece->getSymbol() == 'P' || piece->getSymbol() == 'p') {
+                if (piece.getSymbol() == 'K') whiteKingCount++;
+                if (piece.getSymbol() == 'k') blackKingCount++;
+                if (piece.getSymbol() == 'P' || piece.getSymbol() == 'p') {
                     if (y == 0 || y == 7) {
                         std::cout << "Pawns cannot be on the first or last rank of the board." << std::endl;
                         return false;
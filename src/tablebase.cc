@@ -0,0 +1,384 @@
+#include "tablebase.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "attacks.h"
+#include "movegen.h"
+
+Tablebases tablebases;
+
+const char TB_MAGIC[8] = {'C', 'H', 'E', 'S', 'S', 'T', 'B', '1'};
+
+// Squares the white king is folded onto, and each square's place among them
+struct KingRegions {
+    int squares[2][32];
+    int indexOf[2][64];
+    int size[2];
+
+    KingRegions() : squares(), indexOf(), size() {
+        for (int pawns = 0; pawns < 2; ++pawns) {
+            for (int square = 0; square < 64; ++square) {
+                int file = square & 7, rank = square >> 3;
+                bool inside = pawns ? file < 4 : file < 4 && rank <= file;
+                indexOf[pawns][square] = inside ? size[pawns] : -1;
+                if (inside) {
+                    squares[pawns][size[pawns]++] = square;
+                }
+            }
+        }
+    }
+};
+
+static const KingRegions kingRegions;
+
+// Mirrors applied in turn: files, ranks, then the a1-h8 diagonal
+static int transform(int square, int mirrors) {
+    if (mirrors & 1) square ^= 7;
+    if (mirrors & 2) square ^= 56;
+    if (mirrors & 4) square = ((square & 7) << 3) | (square >> 3);
+    return square;
+}
+
+static int pieceLetterType(char letter) {
+    const char* letters = "PNBRQK";
+    const char* found = std::strchr(letters, letter);
+    return letter && found ? int(found - letters) : -1;
+}
+
+bool TBMaterial::parse(const std::string& name, TBMaterial& material) {
+    size_t split = name.find('v');
+    if (split == std::string::npos) {
+        return false;
+    }
+    material.name = name;
+    material.count = 0;
+    material.hasPawns = false;
+    for (int color = WHITE; color <= BLACK; ++color) {
+        std::string side = color == WHITE ? name.substr(0, split) : name.substr(split + 1);
+        if (side.empty() || side[0] != 'K') {
+            return false;
+        }
+        // Queen down to pawn after the king
+        int start = material.count;
+        for (size_t i = 0; i < side.size(); ++i) {
+            int type = pieceLetterType(side[i]);
+            if (type < 0 || (type == KING) != (i == 0) || material.count == TB_MAX_PIECES) {
+                return false;
+            }
+            uint8_t code = makePieceCode(Color(color), PieceType(type));
+            int at = material.count++;
+            while (at > start + 1 && pieceCodeType(material.codes[at - 1]) < type) {
+                material.codes[at] = material.codes[at - 1];
+                --at;
+            }
+            material.codes[at] = code;
+            material.hasPawns |= type == PAWN;
+        }
+    }
+    material.size = 2 * size_t(kingRegions.size[material.hasPawns]);
+    for (int i = 1; i < material.count; ++i) {
+        material.size *= 64;
+    }
+    return material.count >= 3;
+}
+
+bool TBMaterial::indexOf(const BoardState& state, bool flip, size_t& index) const {
+    if (popCount(state.occupied()) != count) {
+        return false;
+    }
+    int squares[TB_MAX_PIECES];
+    Bitboard taken = 0;
+    for (int i = 0; i < count; ++i) {
+        Color color = Color(pieceCodeColor(codes[i]) ^ flip);
+        Bitboard candidates = state.pieces[color][pieceCodeType(codes[i])] & ~taken;
+        if (!candidates) {
+            return false;
+        }
+        int square = lsb(candidates);
+        taken |= squareBB(square);
+        squares[i] = flip ? square ^ 56 : square;
+    }
+
+    int mirrors = 0;
+    int king = squares[0];
+    if ((king & 7) > 3) {
+        mirrors |= 1;
+        king ^= 7;
+    }
+    if (!hasPawns && (king >> 3) > 3) {
+        mirrors |= 2;
+        king ^= 56;
+    }
+    if (!hasPawns && (king >> 3) > (king & 7)) {
+        mirrors |= 4;
+        king = transform(king, 4);
+    }
+
+    index = state.whiteTurn != flip ? 0 : 1;
+    index = index * kingRegions.size[hasPawns] + kingRegions.indexOf[hasPawns][king];
+    for (int i = 1; i < count; ++i) {
+        index = index * 64 + transform(squares[i], mirrors);
+    }
+    return true;
+}
+
+bool TBMaterial::positionAt(size_t index, BoardState& state) const {
+    int squares[TB_MAX_PIECES];
+    for (int i = count - 1; i > 0; --i) {
+        squares[i] = int(index % 64);
+        index /= 64;
+    }
+    squares[0] = kingRegions.squares[hasPawns][index % kingRegions.size[hasPawns]];
+    index /= kingRegions.size[hasPawns];
+
+    state.clear();
+    state.castling = NO_CASTLING;
+    state.whiteTurn = index == 0;
+    for (int i = 0; i < count; ++i) {
+        int rank = squares[i] >> 3;
+        if (state.mailbox[squares[i]] != NO_PIECE || (pieceCodeType(codes[i]) == PAWN && (rank == 0 || rank == 7))) {
+            return false;
+        }
+        state.put(squares[i], codes[i]);
+    }
+    return true;
+}
+
+uint64_t materialSignature(const BoardState& state) {
+    uint64_t signature = 0;
+    for (int color = WHITE; color <= BLACK; ++color) {
+        for (int type = PAWN; type < PIECE_TYPE_NB; ++type) {
+            signature += uint64_t(popCount(state.pieces[color][type])) << (4 * makePieceCode(Color(color), PieceType(type)));
+        }
+    }
+    return signature;
+}
+
+uint64_t materialSignature(const TBMaterial& material) {
+    uint64_t signature = 0;
+    for (int i = 0; i < material.count; ++i) {
+        signature += uint64_t(1) << (4 * material.codes[i]);
+    }
+    return signature;
+}
+
+// The same material with the colours swapped: white codes are 1-6, black 9-14
+static uint64_t flippedSignature(uint64_t signature) {
+    const uint64_t side = 0x0FFFFFF0;
+    return ((signature & side) << 32) | ((signature >> 32) & side);
+}
+
+BoardState positionAfter(const BoardState& state, const Move& move) {
+    BoardState child = state;
+    int from = move.from();
+    int to = move.to();
+    uint8_t moved = child.remove(from);
+    child.remove(move.flag() == EN_PASSANT ? squareOf(to & 7, from >> 3) : to);
+    child.put(to, move.isPromotion() ? makePieceCode(pieceCodeColor(moved), move.promotion()) : moved);
+    child.whiteTurn = !child.whiteTurn;
+    child.castling = NO_CASTLING;
+    child.epFile = pieceCodeType(moved) == PAWN && std::abs(to - from) == 16 ? uint8_t(from & 7) : NO_EN_PASSANT;
+    return child;
+}
+
+bool enPassantAvailable(const BoardState& state) {
+    if (state.epFile == NO_EN_PASSANT) {
+        return false;
+    }
+    MoveList captures;
+    generateLegalMoves(state, state.whiteTurn ? WHITE : BLACK, captures, CAPTURES);
+    return std::any_of(captures.begin(), captures.end(), [](const Move& move) { return move.flag() == EN_PASSANT; });
+}
+
+// Tables know nothing of castling
+static bool coveredByTables(const BoardState& state) {
+    return state.castling == NO_CASTLING;
+}
+
+static TBResult resultOf(uint8_t value) {
+    if (value == TB_DRAW) {
+        return {0, 0};
+    }
+    int distance = value - 1;
+    return {distance % 2 ? 1 : -1, distance};
+}
+
+// The quickest win if a move reaches a lost position, otherwise a draw if one
+// reaches a draw, otherwise the slowest loss. An unknown value only matters
+// when no win is found: the move could still turn out to win.
+uint8_t valueByMoves(const BoardState& state, const std::function<uint8_t(const Move&)>& valueAfter) {
+    Color us = state.whiteTurn ? WHITE : BLACK;
+    MoveList moves;
+    generateLegalMoves(state, us, moves);
+    if (moves.size() == 0) {
+        bool inCheck = attackersTo(state, lsb(state.pieces[us][KING]), state.occupied()) & state.byColor[us ^ 1];
+        return inCheck ? uint8_t(1) : TB_DRAW;
+    }
+    int quickestWin = TB_MAX_DISTANCE + 1;
+    int slowestLoss = -1;
+    bool draw = false, unknown = false;
+    for (const Move& move : moves) {
+        uint8_t value = valueAfter(move);
+        if (value == TB_INVALID) {
+            return TB_INVALID;
+        }
+        if (value == TB_UNKNOWN) {
+            unknown = true;
+        } else if (value == TB_DRAW) {
+            draw = true;
+        } else if ((value - 1) % 2 == 0) {
+            // Lost for the side then to move, so won one ply further from here
+            quickestWin = std::min(quickestWin, int(value));
+        } else {
+            slowestLoss = std::max(slowestLoss, int(value));
+        }
+    }
+    if (quickestWin <= TB_MAX_DISTANCE) return uint8_t(quickestWin + 1);
+    if (unknown) return TB_UNKNOWN;
+    if (draw) return TB_DRAW;
+    return uint8_t(slowestLoss + 1);
+}
+
+Tablebases::~Tablebases() {
+    clear();
+}
+
+bool Tablebases::add(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    std::string file = slash == std::string::npos ? path : path.substr(slash + 1);
+    TBMaterial material;
+    if (file.size() < 4 || file.compare(file.size() - 3, 3, ".tb") != 0
+        || !TBMaterial::parse(file.substr(0, file.size() - 3), material)) {
+        return false;
+    }
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    void* mapped = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && size_t(info.st_size) == sizeof(TB_MAGIC) + material.size) {
+        mapped = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    if (std::memcmp(mapped, TB_MAGIC, sizeof(TB_MAGIC)) != 0) {
+        munmap(mapped, size_t(info.st_size));
+        return false;
+    }
+
+    // A newer file for the same material replaces the old one
+    Table table = {material, materialSignature(material),
+                   static_cast<const uint8_t*>(mapped) + sizeof(TB_MAGIC), size_t(info.st_size)};
+    for (Table& existing : tables) {
+        if (existing.signature == table.signature || existing.signature == flippedSignature(table.signature)) {
+            munmap(const_cast<uint8_t*>(existing.values - sizeof(TB_MAGIC)), existing.mappedSize);
+            existing = table;
+            return true;
+        }
+    }
+    tables.push_back(table);
+    largest = std::max(largest, material.count);
+    return true;
+}
+
+int Tablebases::load(const std::string& directory) {
+    DIR* dir = opendir(directory.c_str());
+    if (!dir) {
+        return 0;
+    }
+    int found = 0;
+    while (dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, ".tb") == 0 && add(directory + "/" + name)) {
+            ++found;
+        }
+    }
+    closedir(dir);
+    return found;
+}
+
+void Tablebases::clear() {
+    for (Table& table : tables) {
+        munmap(const_cast<uint8_t*>(table.values - sizeof(TB_MAGIC)), table.mappedSize);
+    }
+    tables.clear();
+    largest = 0;
+}
+
+bool Tablebases::probeValue(const BoardState& state, uint8_t& value) const {
+    int count = popCount(state.occupied());
+    if (count > largest) {
+        return false;
+    }
+    if (count == 2) {
+        value = TB_DRAW;
+        return true;
+    }
+    // After a double push no table stores: the best of the moves from here,
+    // each of which leads back into the tables
+    if (enPassantAvailable(state)) {
+        value = valueByMoves(state, [&](const Move& move) {
+            uint8_t after;
+            return probeValue(positionAfter(state, move), after) ? after : TB_INVALID;
+        });
+        return value != TB_INVALID;
+    }
+    uint64_t signature = materialSignature(state);
+    for (const Table& table : tables) {
+        size_t index;
+        if ((table.signature == signature && table.material.indexOf(state, false, index))
+            || (table.signature == flippedSignature(signature) && table.material.indexOf(state, true, index))) {
+            value = table.values[index];
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Tablebases::probe(const BoardState& state, TBResult& result) const {
+    uint8_t value;
+    if (!coveredByTables(state) || !probeValue(state, value) || value == TB_INVALID) {
+        return false;
+    }
+    result = resultOf(value);
+    return true;
+}
+
+bool Tablebases::probeRoot(const BoardState& state, Move& best, TBResult& result) const {
+    if (!coveredByTables(state) || popCount(state.occupied()) > largest) {
+        return false;
+    }
+    MoveList moves;
+    generateLegalMoves(state, state.whiteTurn ? WHITE : BLACK, moves);
+    if (moves.size() == 0) {
+        return false;
+    }
+
+    // Ranked from our side: a quicker win beats a slower one, which beats a
+    // draw, which beats a slower loss, which beats a quicker one
+    int bestRank = 0;
+    for (const Move& move : moves) {
+        uint8_t value;
+        if (!probeValue(positionAfter(state, move), value) || value == TB_INVALID) {
+            return false;
+        }
+        TBResult theirs = resultOf(value);
+        int rank = theirs.outcome < 0 ? 2 * TB_MAX_DISTANCE - theirs.pliesToMate
+                 : theirs.outcome == 0 ? TB_MAX_DISTANCE : theirs.pliesToMate;
+        if (rank > bestRank) {
+            bestRank = rank;
+            best = move;
+            result = {-theirs.outcome, theirs.outcome ? theirs.pliesToMate + 1 : 0};
+        }
+    }
+    return true;
+}
@@ -0,0 +1,112 @@
+#include "tt.h"
+#include <cstring>
+
+// Data word layout: bits 0-15 move, 16-31 score, 32-39 depth, 40-41 bound,
+// 42-47 generation. An all-zero word is an empty entry.
+static uint64_t pack(Move move, int score, int depth, Bound bound, uint8_t generation) {
+    return uint64_t(move.raw())
+         | uint64_t(uint16_t(int16_t(score))) << 16
+         | uint64_t(uint8_t(int8_t(depth))) << 32
+         | uint64_t(bound) << 40
+         | uint64_t(generation & 63) << 42;
+}
+
+static int depthOf(uint64_t data) {
+    return int8_t(data >> 32);
+}
+
+static uint8_t generationOf(uint64_t data) {
+    return (data >> 42) & 63;
+}
+
+TranspositionTable::TranspositionTable() : buckets(nullptr), bucketMask(0), generation(0) {}
+
+TranspositionTable::TranspositionTable(size_t megabytes) : TranspositionTable() {
+    resize(megabytes);
+}
+
+void TranspositionTable::resize(size_t megabytes) {
+    size_t count = 1;
+    while (count * 2 * sizeof(Bucket) <= megabytes << 20) {
+        count *= 2;
+    }
+
+    memory.reset();
+    buckets = nullptr;
+    bucketMask = 0;
+    if (!megabytes) {
+        return;
+    }
+
+    // Over-allocate so the buckets can start on a cache line boundary
+    memory.reset(new char[count * sizeof(Bucket) + 63]);
+    buckets = reinterpret_cast<Bucket*>((reinterpret_cast<uintptr_t>(memory.get()) + 63) & ~uintptr_t(63));
+    bucketMask = count - 1;
+    clear();
+}
+
+void TranspositionTable::clear() {
+    if (buckets) {
+        std::memset(static_cast<void*>(buckets), 0, (bucketMask + 1) * sizeof(Bucket));
+    }
+    generation = 0;
+}
+
+void TranspositionTable::newSearch() {
+    generation = (generation + 1) & 63;
+}
+
+bool TranspositionTable::probe(uint64_t key, TTData& result) const {
+    if (!buckets) {
+        return false;
+    }
+
+    for (const Entry& entry : bucketOf(key).entries) {
+        uint64_t data = entry.data.load(std::memory_order_relaxed);
+        if (data && (entry.check.load(std::memory_order_relaxed) ^ data) == key) {
+            result.move = Move::fromRaw(uint16_t(data));
+            result.score = int16_t(data >> 16);
+            result.depth = depthOf(data);
+            result.bound = Bound((data >> 40) & 3);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, Move move, int score, int depth, Bound bound) {
+    if (!buckets) {
+        return;
+    }
+
+    // Overwrite the position's own entry if it has one. Otherwise evict the
+    // entry with the least depth, counting each search of age as 8 plies.
+    Entry* target = nullptr;
+    int worst = 0;
+    for (Entry& entry : bucketOf(key).entries) {
+        uint64_t data = entry.data.load(std::memory_order_relaxed);
+        if (data && (entry.check.load(std::memory_order_relaxed) ^ data) == key) {
+            // Within one search a much shallower bound doesn't replace a deeper
+            // result. Keep the old best move when there is no new one.
+            if (bound != BOUND_EXACT && generationOf(data) == generation && depth < depthOf(data) - 3) {
+                return;
+            }
+            if (move == Move(0, 0)) {
+                move = Move::fromRaw(uint16_t(data));
+            }
+            target = &entry;
+            break;
+        }
+
+        int age = (generation - generationOf(data)) & 63;
+        int value = data ? depthOf(data) - 8 * age : -1000;
+        if (!target || value < worst) {
+            target = &entry;
+            worst = value;
+        }
+    }
+
+    uint64_t data = pack(move, score, depth, bound, generation);
+    target->data.store(data, std::memory_order_relaxed);
+    target->check.store(key ^ data, std::memory_order_relaxed);
+}
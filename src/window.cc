@@ -1,6 +1,7 @@
 #include "window.h"
 #include <SFML/Graphics.hpp>
 #include <iostream>
+#include <unordered_map>
 
 SFMLWindow::SFMLWindow(int width, int height) 
     : window(sf::VideoMode(width, height), "Chess Game") {
@@ -85,13 +86,19 @@ void SFMLWindow::drawPeice(int x, int y, char piece, int colour) {
     window.draw(text);
 }
 
-void SFMLWindow::processEvents() {
+SFMLWindow::Request SFMLWindow::processEvents() {
+    Request request = NoRequest;
     sf::Event event;
     while (window.pollEvent(event)) {
         if (event.type == sf::Event::Closed) {
             window.close();
+        } else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Space) {
+            request = MoveNow;
+        } else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape) {
+            request = AbortSearch;
         }
     }
+    return request;
 }
 
 void SFMLWindow::clear(int colour) {
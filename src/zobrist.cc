@@ -0,0 +1,28 @@
+#include "zobrist.h"
+
+// SplitMix64; good enough spread for hashing and cheap to run at compile time
+static constexpr uint64_t nextKey(uint64_t& seed) {
+    seed += 0x9E3779B97F4A7C15ULL;
+    uint64_t z = seed;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr ZobristKeys::ZobristKeys() : piece(), side(), castling(), enPassant() {
+    uint64_t seed = 0x3243F6A8885A308DULL;
+    for (int code = 0; code < 16; ++code) {
+        for (int square = 0; square < 64; ++square) {
+            piece[code][square] = nextKey(seed);
+        }
+    }
+    side = nextKey(seed);
+    for (int rights = 0; rights < 16; ++rights) {
+        castling[rights] = nextKey(seed);
+    }
+    for (int file = 0; file < 8; ++file) {
+        enPassant[file] = nextKey(seed);
+    }
+}
+
+constexpr ZobristKeys zobrist;
@@ -0,0 +1,90 @@
+#include "search.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// Middlegame and endgame positions of varied character. The total node count
+// of a fixed depth search over all of them is a signature of the search: a
+// change that is meant to leave the search alone must not change it.
+static const char* positions[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP1B1PPP/R2QKB1R w KQ - 0 8",
+    "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
+    "8/8/4k3/3p4/3P1K2/8/8/8 w - - 0 1",
+    "4k3/8/8/8/8/8/4P3/4K3 w - - 0 1",
+    "r1b1kb1r/pppp1ppp/5q2/4n3/3KP3/2N3PN/PPP4P/R1BQ1B1R b kq - 0 1",
+    "3r2k1/p4ppp/1p6/2pn4/8/1P2B1P1/P4P1P/3R2K1 b - - 0 24",
+};
+
+static void printUsage() {
+    std::cout << "Usage: bench [options] [depth]    Search every bench position to depth (default 10)" << std::endl;
+    std::cout << "Options: -t <threads>    Search threads (default 1)" << std::endl;
+    std::cout << "         -H <megabytes>  Transposition table size (default 16)" << std::endl;
+    std::cout << "         -n <file>       Evaluate with a network weights file" << std::endl;
+    std::cout << "         -no <feature>   Switch off null, lmr, futility or rfp (reverse futility)" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    int threadCount = 1;
+    int hashMB = 16;
+    SearchOptions options;
+    int arg = 1;
+    for (; arg + 1 < argc && argv[arg][0] == '-'; arg += 2) {
+        const char* value = argv[arg + 1];
+        if (std::strcmp(argv[arg], "-t") == 0) {
+            threadCount = std::max(1, std::atoi(value));
+        } else if (std::strcmp(argv[arg], "-H") == 0) {
+            hashMB = std::max(1, std::atoi(value));
+        } else if (std::strcmp(argv[arg], "-n") == 0) {
+            if (!network.load(value)) {
+                std::cout << "Could not load network file: " << value << std::endl;
+                return 1;
+            }
+            std::cout << "Network " << value << " (" << Network::kernelName() << " kernels)" << std::endl;
+        } else if (std::strcmp(argv[arg], "-no") == 0 && std::strcmp(value, "null") == 0) {
+            options.nullMove = false;
+        } else if (std::strcmp(argv[arg], "-no") == 0 && std::strcmp(value, "lmr") == 0) {
+            options.lateMoveReductions = false;
+        } else if (std::strcmp(argv[arg], "-no") == 0 && std::strcmp(value, "futility") == 0) {
+            options.futility = false;
+        } else if (std::strcmp(argv[arg], "-no") == 0 && std::strcmp(value, "rfp") == 0) {
+            options.reverseFutility = false;
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    SearchLimits limits;
+    limits.depth = arg < argc ? std::atoi(argv[arg]) : 10;
+    if (limits.depth < 1 || arg + 1 < argc) {
+        printUsage();
+        return 1;
+    }
+
+    // A fresh table per position, so results don't depend on the order
+    uint64_t totalNodes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const char* fen : positions) {
+        Board board;
+        board.setFen(fen);
+        TranspositionTable tt(hashMB);
+        Search search(tt, threadCount);
+        search.setOptions(options);
+        SearchResult result = search.run(board, limits);
+        std::cout << result.bestMove.toString() << "  score " << result.score << "  nodes " << result.nodes
+                  << "  " << fen << std::endl;
+        totalNodes += result.nodes;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Nodes: " << totalNodes << "  Time: " << seconds << "s  Nodes/second: "
+              << uint64_t(seconds > 0 ? totalNodes / seconds : 0) << std::endl;
+    return 0;
+}
@@ -0,0 +1,269 @@
+#include "board.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Subtree counts shared by all threads, indexed by position hash. Each slot
+// stores its key XORed with the count, so a slot torn by two threads writing
+// at once fails verification instead of returning a wrong count.
+class PerftTable {
+    struct Entry {
+        std::atomic<uint64_t> check;
+        std::atomic<uint64_t> nodes;
+    };
+
+    std::unique_ptr<Entry[]> entries;
+    uint64_t mask = 0;
+
+    // The same position counted to a different depth must not match
+    static uint64_t keyOf(uint64_t hash, int depth) {
+        return hash ^ (uint64_t(depth) * 0x9E3779B97F4A7C15ULL);
+    }
+
+public:
+    // Rounds down to a power of two number of entries; 0 MB disables the table
+    void resize(size_t megabytes) {
+        size_t count = 1;
+        while (count * 2 * sizeof(Entry) <= megabytes << 20) {
+            count *= 2;
+        }
+        entries.reset(megabytes ? new Entry[count]() : nullptr);
+        mask = count - 1;
+    }
+
+    bool enabled() const {
+        return entries != nullptr;
+    }
+
+    bool probe(uint64_t hash, int depth, uint64_t& nodes) const {
+        const Entry& entry = entries[hash & mask];
+        uint64_t stored = entry.nodes.load(std::memory_order_relaxed);
+        if ((entry.check.load(std::memory_order_relaxed) ^ stored) != keyOf(hash, depth)) {
+            return false;
+        }
+        nodes = stored;
+        return true;
+    }
+
+    void store(uint64_t hash, int depth, uint64_t nodes) {
+        Entry& entry = entries[hash & mask];
+        entry.check.store(keyOf(hash, depth) ^ nodes, std::memory_order_relaxed);
+        entry.nodes.store(nodes, std::memory_order_relaxed);
+    }
+};
+
+static PerftTable table;
+
+// Counts the leaf nodes of the legal move tree. The last ply is not played:
+// the size of the generated list is the number of leaves below it.
+static uint64_t perft(Board& board, int depth) {
+    MoveList moves;
+    generateLegalMoves(board.getState(), board.isWhiteTurn() ? WHITE : BLACK, moves);
+    if (depth <= 1) {
+        return depth == 1 ? moves.size() : 1;
+    }
+
+    uint64_t nodes = 0;
+    bool cached = depth > 2 && table.enabled();
+    if (cached && table.probe(board.hash(), depth, nodes)) {
+        return nodes;
+    }
+
+    for (const Move& move : moves) {
+        board.makeMove(move);
+        nodes += perft(board, depth - 1);
+        board.unmakeMove();
+    }
+
+    if (cached) {
+        table.store(board.hash(), depth, nodes);
+    }
+    return nodes;
+}
+
+// Perft with the count below every root move, for finding the line where two
+// move generators disagree. The subtrees two plies down are handed out to the
+// threads one at a time from a shared counter, so a thread that finishes a
+// small subtree immediately takes the next one.
+static uint64_t divide(Board& board, int depth, int threadCount, bool print = true) {
+    MoveList rootMoves;
+    generateLegalMoves(board.getState(), board.isWhiteTurn() ? WHITE : BLACK, rootMoves);
+
+    struct Task {
+        int root;
+        Move reply;
+    };
+    std::vector<Task> tasks;
+    std::vector<uint64_t> leaves(rootMoves.size(), depth == 1 ? 1 : 0);
+    if (depth > 1) {
+        for (int i = 0; i < rootMoves.size(); ++i) {
+            board.makeMove(rootMoves[i]);
+            MoveList replies;
+            generateLegalMoves(board.getState(), board.isWhiteTurn() ? WHITE : BLACK, replies);
+            if (depth == 2) {
+                leaves[i] = replies.size();
+            } else {
+                for (const Move& reply : replies) {
+                    tasks.push_back({i, reply});
+                }
+            }
+            board.unmakeMove();
+        }
+    }
+
+    std::unique_ptr<std::atomic<uint64_t>[]> counts(new std::atomic<uint64_t>[rootMoves.size()]());
+    std::atomic<size_t> nextTask(0);
+    auto worker = [&]() {
+        Board local(board);
+        for (size_t i = nextTask++; i < tasks.size(); i = nextTask++) {
+            local.makeMove(rootMoves[tasks[i].root]);
+            local.makeMove(tasks[i].reply);
+            counts[tasks[i].root] += perft(local, depth - 2);
+            local.unmakeMove();
+            local.unmakeMove();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < threadCount; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    uint64_t nodes = 0;
+    for (int i = 0; i < rootMoves.size(); ++i) {
+        uint64_t count = leaves[i] + counts[i];
+        if (print) {
+            std::cout << rootMoves[i].toString() << ": " << count << std::endl;
+        }
+        nodes += count;
+    }
+    return nodes;
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void printSpeed(uint64_t nodes, double seconds) {
+    std::cout << "Nodes: " << nodes << "  Time: " << seconds << "s  Nodes/second: "
+              << uint64_t(seconds > 0 ? nodes / seconds : 0) << std::endl;
+}
+
+// Standard test positions and their published leaf counts by depth
+struct SuitePosition {
+    const char* name;
+    const char* fen;
+    uint64_t nodes[6];
+};
+
+static const SuitePosition suite[] = {
+    {"Start position", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        {20, 400, 8902, 197281, 4865609, 119060324}},
+    {"Kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        {48, 2039, 97862, 4085603, 193690690, 0}},
+    {"Position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        {14, 191, 2812, 43238, 674624, 11030083}},
+    {"Position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        {6, 264, 9467, 422333, 15833292, 0}},
+    {"Position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        {44, 1486, 62379, 2103487, 89941194, 0}},
+    {"Position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+        {46, 2079, 89890, 3894594, 164075551, 0}},
+};
+
+// Runs every suite position to maxDepth and compares against the known counts
+static bool runSuite(int maxDepth, int threadCount) {
+    bool passed = true;
+    uint64_t totalNodes = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (const SuitePosition& position : suite) {
+        Board board;
+        board.setFen(position.fen);
+        for (int depth = 1; depth <= maxDepth && depth <= 6 && position.nodes[depth - 1]; ++depth) {
+            uint64_t nodes = divide(board, depth, threadCount, false);
+            bool ok = nodes == position.nodes[depth - 1];
+            std::cout << (ok ? "ok    " : "FAIL  ") << position.name << " depth " << depth << ": " << nodes;
+            if (!ok) {
+                std::cout << " (expected " << position.nodes[depth - 1] << ")";
+            }
+            std::cout << std::endl;
+            passed = passed && ok;
+            totalNodes += nodes;
+        }
+    }
+
+    printSpeed(totalNodes, secondsSince(start));
+    std::cout << (passed ? "All positions passed." : "Some positions FAILED.") << std::endl;
+    return passed;
+}
+
+static void printUsage() {
+    std::cout << "Usage: perft [options] <depth> [fen]    Count leaf nodes with a per-move breakdown" << std::endl;
+    std::cout << "       perft [options] suite [depth]    Check the standard positions up to depth (default 4)" << std::endl;
+    std::cout << "Options: -t <threads>    Worker threads (default: one per core)" << std::endl;
+    std::cout << "         -H <megabytes>  Cache subtree counts in a shared hash table (default: off)" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    int threadCount = std::max(1u, std::thread::hardware_concurrency());
+    int arg = 1;
+    for (; arg + 1 < argc && argv[arg][0] == '-'; arg += 2) {
+        if (std::strcmp(argv[arg], "-t") == 0) {
+            threadCount = std::max(1, std::atoi(argv[arg + 1]));
+        } else if (std::strcmp(argv[arg], "-H") == 0) {
+            table.resize(std::max(0, std::atoi(argv[arg + 1])));
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (arg >= argc) {
+        printUsage();
+        return 1;
+    }
+
+    if (std::strcmp(argv[arg], "suite") == 0) {
+        int depth = arg + 1 < argc ? std::atoi(argv[arg + 1]) : 4;
+        return runSuite(depth, threadCount) ? 0 : 1;
+    }
+
+    int depth = std::atoi(argv[arg]);
+    if (depth < 1) {
+        printUsage();
+        return 1;
+    }
+
+    // The FEN may be passed as one argument or as its space separated fields
+    Board board;
+    if (arg + 1 < argc) {
+        std::string fen = argv[arg + 1];
+        for (int i = arg + 2; i < argc; ++i) {
+            fen += std::string(" ") + argv[i];
+        }
+        if (!board.setFen(fen)) {
+            std::cout << "Invalid FEN: " << fen << std::endl;
+            return 1;
+        }
+    } else {
+        board.setupBoard();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t nodes = divide(board, depth, threadCount);
+    std::cout << std::endl;
+    printSpeed(nodes, secondsSince(start));
+    return 0;
+}
@@ -0,0 +1,357 @@
+#include "tablebase.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "attacks.h"
+#include "movegen.h"
+
+// Builds endgame tables by retrograde analysis. Every position of the
+// material set is scored in passes of increasing distance to mate: pass n
+// marks as won in n plies each position with a move into a position lost in
+// n - 1, and as lost in n each position all of whose moves lead to positions
+// won in at most n - 1. A position a move takes out of the table, by a
+// capture or a promotion, is looked up in the smaller table built first, and
+// one after a double push that allows an en passant capture is scored
+// through its replies.
+// What no pass reaches is a draw. A position marked in pass n only matches
+// the test of pass n + 1, so the threads sharing a pass can't see each other's
+// writes too early.
+
+const size_t CHUNK = 4096;
+
+static std::string directory = ".";
+static int threadCount = 1;
+static std::set<std::string> ready;
+
+// Runs work over [0, size) in chunks handed out from a shared counter
+static void parallelFor(size_t size, const std::function<void(size_t, size_t)>& work) {
+    std::atomic<size_t> nextChunk(0);
+    auto worker = [&]() {
+        for (size_t begin = CHUNK * nextChunk++; begin < size; begin = CHUNK * nextChunk++) {
+            work(begin, std::min(size, begin + CHUNK));
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int i = 1; i < threadCount; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+static int pieceValue(char letter) {
+    switch (letter) {
+    case 'Q': return 9;
+    case 'R': return 5;
+    case 'B': case 'N': return 3;
+    case 'P': return 1;
+    default: return 0;
+    }
+}
+
+// Name of a material set with each side's pieces from queen down, the
+// stronger side first
+static std::string canonicalName(std::string white, std::string black) {
+    const std::string order = "QRBNP";
+    auto byOrder = [&](char a, char b) { return order.find(a) < order.find(b); };
+    std::sort(white.begin(), white.end(), byOrder);
+    std::sort(black.begin(), black.end(), byOrder);
+    int whiteValue = 0, blackValue = 0;
+    for (char letter : white) whiteValue += pieceValue(letter);
+    for (char letter : black) blackValue += pieceValue(letter);
+    bool blackStronger = blackValue != whiteValue ? blackValue > whiteValue
+                       : black.size() != white.size() ? black.size() > white.size()
+                       : std::lexicographical_compare(black.begin(), black.end(), white.begin(), white.end(), byOrder);
+    if (blackStronger) {
+        std::swap(white, black);
+    }
+    return "K" + white + "vK" + black;
+}
+
+// Material sets a capture or a promotion can lead to, bare kings excepted
+static std::vector<std::string> successors(const std::string& name) {
+    size_t split = name.find('v');
+    std::string sides[2] = {name.substr(1, split - 1), name.substr(split + 2)};
+    std::vector<std::string> found;
+    auto record = [&](const std::string& white, const std::string& black) {
+        if (!white.empty() || !black.empty()) {
+            found.push_back(canonicalName(white, black));
+        }
+    };
+    for (int side = 0; side < 2; ++side) {
+        std::string& ours = sides[side];
+        std::string& theirs = sides[side ^ 1];
+        for (size_t i = 0; i < theirs.size(); ++i) {
+            std::string captured = theirs;
+            captured.erase(i, 1);
+            record(side ? captured : ours, side ? ours : captured);
+        }
+        for (size_t i = 0; i < ours.size(); ++i) {
+            if (ours[i] != 'P') {
+                continue;
+            }
+            for (char promotion : std::string("QRBN")) {
+                std::string promoted = ours;
+                promoted[i] = promotion;
+                record(side ? theirs : promoted, side ? promoted : theirs);
+                for (size_t j = 0; j < theirs.size(); ++j) {
+                    std::string captured = theirs;
+                    captured.erase(j, 1);
+                    record(side ? captured : promoted, side ? promoted : captured);
+                }
+            }
+        }
+    }
+    return found;
+}
+
+// Writes the table to path, false if it can't. The file is opened first, so
+// an unwritable directory fails before any pass runs.
+static bool generate(const TBMaterial& material, const std::string& path) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    auto start = std::chrono::steady_clock::now();
+    size_t size = material.size;
+    std::unique_ptr<std::atomic<uint8_t>[]> values(new std::atomic<uint8_t>[size]);
+    uint64_t signature = materialSignature(material);
+
+    // Moves that can leave this table
+    auto changesMaterial = [&](const BoardState& state, const Move& move) {
+        return state.mailbox[move.to()] != NO_PIECE || move.isPromotion() || move.flag() == EN_PASSANT;
+    };
+
+    // The value after a move, from the point of view of the side then to move.
+    // No table stores a position with an en passant capture available, so
+    // after such a double push it is the best of the replies.
+    std::function<uint8_t(const BoardState&, const Move&)> valueAfter;
+    valueAfter = [&](const BoardState& state, const Move& move) -> uint8_t {
+        BoardState child = positionAfter(state, move);
+        size_t index;
+        uint8_t value = TB_UNKNOWN;
+        if (enPassantAvailable(child)) {
+            value = valueByMoves(child, [&](const Move& reply) { return valueAfter(child, reply); });
+        } else if (!changesMaterial(state, move)) {
+            material.indexOf(child, false, index);
+            value = values[index].load(std::memory_order_relaxed);
+        } else if (materialSignature(child) == signature && material.indexOf(child, false, index)) {
+            value = values[index].load(std::memory_order_relaxed);
+        } else {
+            tablebases.probeValue(child, value);
+        }
+        return value;
+    };
+
+    // The longest mate in another table a move leads into, counting the plies
+    // through positions after a double push, or -1
+    std::function<int(const BoardState&, const Move&)> outsideAfter;
+    outsideAfter = [&](const BoardState& state, const Move& move) -> int {
+        BoardState child = positionAfter(state, move);
+        int longest = -1;
+        uint8_t value;
+        if (enPassantAvailable(child)) {
+            MoveList replies;
+            generateLegalMoves(child, child.whiteTurn ? WHITE : BLACK, replies);
+            for (const Move& reply : replies) {
+                int after = outsideAfter(child, reply);
+                if (after >= 0) {
+                    longest = std::max(longest, after + 1);
+                }
+            }
+        } else if (changesMaterial(state, move) && materialSignature(child) != signature
+                   && tablebases.probeValue(child, value) && value != TB_DRAW) {
+            longest = value - 1;
+        }
+        return longest;
+    };
+
+    // Mates, stalemates and impossible positions, and the longest mate of the
+    // tables moves lead into
+    std::atomic<int> longestOutside(0);
+    parallelFor(size, [&](size_t begin, size_t end) {
+        BoardState state;
+        int longest = 0;
+        for (size_t i = begin; i < end; ++i) {
+            if (!material.positionAt(i, state)) {
+                values[i] = TB_INVALID;
+                continue;
+            }
+            Color us = state.whiteTurn ? WHITE : BLACK;
+            Color them = Color(us ^ 1);
+            if (attackersTo(state, lsb(state.pieces[them][KING]), state.occupied()) & state.byColor[us]) {
+                values[i] = TB_INVALID;
+                continue;
+            }
+            MoveList moves;
+            generateLegalMoves(state, us, moves);
+            if (moves.size() == 0) {
+                bool inCheck = attackersTo(state, lsb(state.pieces[us][KING]), state.occupied()) & state.byColor[them];
+                values[i] = inCheck ? uint8_t(1) : TB_DRAW;
+                continue;
+            }
+            values[i] = TB_UNKNOWN;
+            for (const Move& move : moves) {
+                longest = std::max(longest, outsideAfter(state, move));
+            }
+        }
+        int seen = longestOutside;
+        while (longest > seen && !longestOutside.compare_exchange_weak(seen, longest)) {}
+    });
+
+    int quietPasses = 0;
+    int distance = 1;
+    for (; distance <= TB_MAX_DISTANCE && (quietPasses < 2 || distance <= longestOutside + 1); ++distance) {
+        bool winning = distance % 2 == 1;
+        std::atomic<size_t> marked(0);
+        parallelFor(size, [&](size_t begin, size_t end) {
+            size_t count = 0;
+            for (size_t i = begin; i < end; ++i) {
+                if (values[i].load(std::memory_order_relaxed) != TB_UNKNOWN) {
+                    continue;
+                }
+                BoardState state;
+                material.positionAt(i, state);
+                MoveList moves;
+                generateLegalMoves(state, state.whiteTurn ? WHITE : BLACK, moves);
+                bool found = !winning;
+                for (const Move& move : moves) {
+                    uint8_t value = valueAfter(state, move);
+                    int after = value - 1;
+                    if (winning && value != TB_DRAW && after == distance - 1) {
+                        found = true;
+                        break;
+                    }
+                    if (!winning && (value == TB_DRAW || value >= TB_UNKNOWN || after % 2 == 0 || after > distance - 1)) {
+                        found = false;
+                        break;
+                    }
+                }
+                if (found) {
+                    values[i].store(uint8_t(distance + 1), std::memory_order_relaxed);
+                    ++count;
+                }
+            }
+            marked += count;
+        });
+        quietPasses = marked ? 0 : quietPasses + 1;
+    }
+
+    // Counted with white to move, the first half of the table
+    size_t wins = 0, draws = 0, losses = 0;
+    int longest = 0;
+    for (size_t i = 0; i < size; ++i) {
+        uint8_t value = values[i];
+        if (value == TB_UNKNOWN) {
+            values[i] = value = TB_DRAW;
+        }
+        if (value != TB_INVALID && value != TB_DRAW) {
+            longest = std::max(longest, value - 1);
+        }
+        if (i >= size / 2 || value == TB_INVALID) {
+            continue;
+        }
+        if (value == TB_DRAW) {
+            ++draws;
+        } else if ((value - 1) % 2) {
+            ++wins;
+        } else {
+            ++losses;
+        }
+    }
+
+    std::vector<char> bytes(size);
+    for (size_t i = 0; i < size; ++i) {
+        bytes[i] = char(values[i].load(std::memory_order_relaxed));
+    }
+    file.write(TB_MAGIC, sizeof(TB_MAGIC));
+    file.write(bytes.data(), std::streamsize(size));
+    file.close();
+    if (!file) {
+        std::remove(path.c_str());
+        return false;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << material.name << ": " << wins << " won, " << draws << " drawn, " << losses
+              << " lost with white to move, longest mate " << longest << " plies, "
+              << distance - 1 << " passes, " << seconds << " s" << std::endl;
+    return true;
+}
+
+// Builds the table unless it is already in the directory, after every table
+// it leads into
+static bool build(const std::string& name) {
+    if (ready.count(name)) {
+        return true;
+    }
+    TBMaterial material;
+    if (!TBMaterial::parse(name, material)) {
+        std::cout << "Not a material set of 3 to " << TB_MAX_PIECES << " pieces: " << name << std::endl;
+        return false;
+    }
+    for (const std::string& successor : successors(name)) {
+        if (!build(successor)) {
+            return false;
+        }
+    }
+
+    std::string path = directory + "/" + name + ".tb";
+    if (!tablebases.add(path) && (!generate(material, path) || !tablebases.add(path))) {
+        std::cout << "Could not write " << path << std::endl;
+        return false;
+    }
+    ready.insert(name);
+    return true;
+}
+
+static void printUsage() {
+    std::cout << "Usage: tbgen [options] <material>...    Build tables such as KQvK, KPvK or KRvKN" << std::endl;
+    std::cout << "Options: -t <threads>    Worker threads (default: one per core)" << std::endl;
+    std::cout << "         -d <directory>  Where tables are read and written (default: current)" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    threadCount = std::max(1u, std::thread::hardware_concurrency());
+    int arg = 1;
+    for (; arg + 1 < argc && argv[arg][0] == '-'; arg += 2) {
+        if (std::strcmp(argv[arg], "-t") == 0) {
+            threadCount = std::max(1, std::atoi(argv[arg + 1]));
+        } else if (std::strcmp(argv[arg], "-d") == 0) {
+            directory = argv[arg + 1];
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (arg >= argc) {
+        printUsage();
+        return 1;
+    }
+
+    // Tables the generator needs are built too, stronger side first
+    for (; arg < argc; ++arg) {
+        std::string name = argv[arg];
+        size_t split = name.find('v');
+        if (split != std::string::npos && name[0] == 'K' && name.compare(split, 2, "vK") == 0) {
+            name = canonicalName(name.substr(1, split - 1), name.substr(split + 2));
+        }
+        if (!build(name)) {
+            return 1;
+        }
+    }
+    return 0;
+}